@@ -7,6 +7,11 @@
  * @see https://github.com/dot-memento/json-lib
  */
 
+// Expose POSIX interfaces (memory mapping, file descriptors) where available.
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "json.h"
 
 #include <stdint.h>
@@ -16,11 +21,56 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <locale.h>
+
+#if !defined(__STDC_NO_ATOMICS__)
+#define JSON_HAS_ATOMICS
+#include <stdatomic.h>
+#endif
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <unistd.h>
+#endif
+
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#define JSON_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(_POSIX_VERSION)
+#define JSON_HAS_WRITEV
+#include <sys/uio.h>
+#endif
+
+// Per-thread locales, to convert numbers independently of the global locale.
+#if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200809L && defined(JSON_HAS_ATOMICS)
+#define JSON_HAS_USELOCALE
+#endif
+
+// Vector instructions used to classify the input in blocks, with a scalar fallback.
+#if defined(__AVX2__)
+#define JSON_HAS_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_HAS_SSE2
+#include <emmintrin.h>
+#endif
 
 #define CHECK_TYPE(entry, expected_type) if ((entry)->type != (expected_type)) return JSON_ERROR_WRONG_TYPE
+#define RESOLVE_CONTENT(entry) do { json_error content_error = resolve_content(&(entry)); if (content_error) return content_error; } while (0)
+#define CHECK_WRITABLE(entry) if ((entry)->flags & SHARED_NODE) return JSON_ERROR_READ_ONLY
+#define MATERIALIZE_CONTENT(entry) do { json_error content_error = materialize_content(entry); if (content_error) return content_error; } while (0)
 
 static const size_t DEFAULT_MAX_DEPTH = 1000;
 static const size_t INITIAL_STRING_BUFFER_SIZE = 16;
+static const size_t DEFAULT_READ_BUFFER_SIZE = 64 * 1024;
+static const size_t INITIAL_PARSE_STACK_SIZE = 64;
+static const size_t INITIAL_CONTAINER_CAPACITY = 4;
 
 #if !defined(_POSIX_C_SOURCE) && !defined(_DEFAULT_SOURCE) && \
     !defined(_BSD_SOURCE) && !defined(_SVID_SOURCE) && \
@@ -37,6 +87,46 @@ static char *strdup(const char *string)
 
 #endif
 
+// --------------------
+// Vectorized Scanning
+// --------------------
+
+// Portable names for the vector operations used to scan chunks of input.
+#if defined(JSON_HAS_AVX2)
+typedef __m256i simd_chunk;
+#define SIMD_CHUNK_SIZE 32
+#define simd_load(data) _mm256_loadu_si256((const __m256i*)(data))
+#define simd_splat(c) _mm256_set1_epi8(c)
+#define simd_eq(a, b) _mm256_cmpeq_epi8(a, b)
+#define simd_or(a, b) _mm256_or_si256(a, b)
+#define simd_sub(a, b) _mm256_sub_epi8(a, b)
+#define simd_min(a, b) _mm256_min_epu8(a, b)
+#define simd_mask(a) ((uint64_t)(uint32_t)_mm256_movemask_epi8(a))
+#elif defined(JSON_HAS_SSE2)
+typedef __m128i simd_chunk;
+#define SIMD_CHUNK_SIZE 16
+#define simd_load(data) _mm_loadu_si128((const __m128i*)(data))
+#define simd_splat(c) _mm_set1_epi8(c)
+#define simd_eq(a, b) _mm_cmpeq_epi8(a, b)
+#define simd_or(a, b) _mm_or_si128(a, b)
+#define simd_sub(a, b) _mm_sub_epi8(a, b)
+#define simd_min(a, b) _mm_min_epu8(a, b)
+#define simd_mask(a) ((uint64_t)(uint16_t)_mm_movemask_epi8(a))
+#endif
+
+// Returns the index of the lowest set bit, which must exist.
+static inline unsigned lowest_bit_index(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(bits);
+#else
+    unsigned index = 0;
+    while (!(bits & 1))
+        bits >>= 1, index++;
+    return index;
+#endif
+}
+
 // --------------------
 // Dynamic String Builder
 // --------------------
@@ -62,20 +152,15 @@ static bool string_builder_ensure_capacity(string_builder *builder, size_t min_c
 {
     if (min_capacity + 1 > builder->allocated_size)
     {
-        char *new_data;
-        if (builder->allocated_size == 0)
-        {
-            builder->allocated_size = INITIAL_STRING_BUFFER_SIZE;
-            new_data = malloc(builder->allocated_size);
-        }
-        else
-        {
-            builder->allocated_size *= 2;
-            new_data = realloc(builder->data, builder->allocated_size);
-        }
+        size_t allocated_size = builder->allocated_size ? builder->allocated_size : INITIAL_STRING_BUFFER_SIZE;
+        while (min_capacity + 1 > allocated_size)
+            allocated_size *= 2;
+
+        char *new_data = realloc(builder->data, allocated_size);
         if (!new_data)
             return true;
         builder->data = new_data;
+        builder->allocated_size = allocated_size;
     }
     return false;
 }
@@ -90,38 +175,17 @@ static bool string_builder_append(string_builder *builder, char c)
     return false;
 }
 
-// Appends a single character to the string builder.
-static bool string_builder_append_string(string_builder *builder, const char *str)
+// Appends a run of bytes to the string builder.
+static bool string_builder_append_bytes(string_builder *builder, const char *data, size_t length)
 {
-    size_t length = strlen(str);
     if (string_builder_ensure_capacity(builder, builder->size + length)) return true;
 
-    memcpy(builder->data + builder->size, str, length);
+    memcpy(builder->data + builder->size, data, length);
     builder->size += length;
     builder->data[builder->size] = '\0';
     return false;
 }
 
-static bool string_builder_append_format(string_builder *builder, const char *format, va_list args)
-{
-    va_list args_copy;
-
-    va_copy(args_copy, args);
-    int length = vsnprintf(NULL, 0, format, args_copy);
-    va_end(args_copy);
-
-    if (length < 0 || string_builder_ensure_capacity(builder, builder->size + length))
-    {
-        va_end(args);
-        return true;
-    }
-
-    vsprintf(builder->data + builder->size, format, args);
-    builder->size += length;
-
-    return false;
-}
-
 // Appends a UTF code point (encoded in UTF-8) to the builder.
 static bool string_builder_append_utf_code_point(string_builder *builder, uint32_t code_point)
 {
@@ -195,6 +259,9 @@ const char* json_error_string(json_error code)
     case JSON_ERROR_UNICODE: return "invalid unicode sequence";
     case JSON_ERROR_BUFFER_TOO_SMALL: return "buffer too small";
     case JSON_ERROR_CIRCULAR_REFERENCE: return "circular reference";
+    case JSON_ERROR_OUT_OF_RANGE: return "number out of range";
+    case JSON_ERROR_DUPLICATE_KEY: return "duplicate key";
+    case JSON_ERROR_READ_ONLY: return "value is shared with clones";
     default: return "unknown error";
     }
 }
@@ -205,1170 +272,5502 @@ const char* json_error_string(json_error code)
 
 typedef struct json_array {
     size_t length;
+    size_t capacity;
     json_value *entry[];
 } json_array;
 
 typedef struct json_object {
     size_t size;
+    size_t capacity;       // Number of members the storage and keys have room for.
     char **keys;
+    size_t *index;         // Hash table of member positions plus one (0 for free slots), NULL if small.
+    size_t index_capacity; // Number of slots of the index, a power of two.
+    size_t *sorted;        // Member positions ordered by key when frozen, in place of the index.
     json_value *entry[];
 } json_object;
 
+// Flags describing where the memory of a json_value comes from, and how numbers are stored.
+enum {
+    VALUE_IN_ARENA   = 1 << 0, // The json_value itself is allocated in a document arena.
+    CONTENT_IN_ARENA = 1 << 1, // Its string, array or object storage is allocated in a document arena.
+    NUMBER_INT64     = 1 << 2, // The number is stored in integer.
+    NUMBER_UINT64    = 1 << 3, // The number is stored in unsigned_integer, only used above INT64_MAX.
+    TEXT_BORROWED    = 1 << 4, // Its string, or its object keys, point into a buffer parsed in situ or a key pool.
+    LAZY_CONTENT     = 1 << 5, // Its array or object is still unparsed text, described by lazy.
+    STRING_INLINE    = 1 << 6, // Its string is stored in small_string, with its length in the last byte.
+    SHARED_CONTENT   = 1 << 7, // Its array or object is shared with clones, described by shared.
+    SHARED_NODE      = 1 << 8  // The value belongs to a tree shared by clones, and can't be modified.
+};
+
+// Strings shorter than this are stored in the value itself, saving an allocation.
+enum { SMALL_STRING_SIZE = 16 };
+
+// Input of a lazy parse, shared by the containers whose parsing was deferred.
+typedef struct lazy_source {
+    size_t references;
+    const char *input;
+    char *insitu_buffer;
+    json_document *document;
+    size_t max_depth;
+    json_duplicate_keys duplicate_keys;
+    json_key_pool *key_pool;
+    bool freeze_objects;
+} lazy_source;
+
+// Text of a nested container left unparsed by a lazy parse, and its value once parsed.
+typedef struct lazy_container {
+    lazy_source *source;
+    const char *start;
+    size_t length;
+    size_t depth;
+    struct json_value *value;
+} lazy_container;
+
+// Container sharing the array or object of a tree with other clones, until it is modified.
+typedef struct shared_container {
+    struct shared_tree *tree;
+    const struct json_value *content;
+} shared_container;
+
 typedef struct json_value {
     json_type type;
+    uint16_t flags;
     union {
         double number;
-        char *string;
+        int64_t integer;
+        uint64_t unsigned_integer;
+        struct {
+            char *string;
+            size_t string_length;
+        };
         bool boolean;
-        json_array *array;
-        json_object *object;
+        struct {
+            union {
+                json_array *array;
+                json_object *object;
+                lazy_container *lazy;
+                shared_container *shared;
+            };
+            // Tree holding the array or object, for the values of a shared tree.
+            struct shared_tree *tree;
+        };
+        char small_string[SMALL_STRING_SIZE];
     };
 } json_value;
 
-// --------------------
-// JSON Creation API
-// --------------------
+// Copy of an array or object made by json_clone, shared by the clones of the value.
+// The values of the tree are marked read-only, and it is freed along with the last container sharing it.
+typedef struct shared_tree {
+#ifdef JSON_HAS_ATOMICS
+    atomic_size_t references;
+#else
+    size_t references;
+#endif
+    json_value root;
+} shared_tree;
 
-json_error json_null_create(json_value **out)
-{
-    if (!out) return JSON_ERROR_NULL;
+static json_error parse_deferred(lazy_container *lazy, json_error_info *error_info);
+static json_error resolve_content(const json_value **entry);
+static json_error materialize_content(json_value *entry);
+static json_error share_content(shared_tree *tree, const json_value *content, json_value **out);
+static void free_content(json_value *entry);
 
-    json_value *entry = malloc(sizeof(json_value));
-    if (!entry) return JSON_ERROR_ALLOCATION;
+// Returns the characters of a string value, wherever they are stored.
+static const char *string_text(const json_value *entry)
+{
+    return entry->flags & STRING_INLINE ? entry->small_string : entry->string;
+}
 
-    *entry = (json_value) {0};
-    entry->type = JSON_NULL;
-    *out = entry;
-    return JSON_SUCCESS;
+// Returns the length of a string value. Inline strings keep the room left after their
+// characters in their last byte, which is also their terminator when they fill it.
+static size_t string_length(const json_value *entry)
+{
+    if (entry->flags & STRING_INLINE)
+        return SMALL_STRING_SIZE - 1 - (unsigned char)entry->small_string[SMALL_STRING_SIZE - 1];
+    return entry->string_length;
 }
 
-json_error json_bool_create(bool value, json_value **out)
+// Stores a string shorter than SMALL_STRING_SIZE in a string value.
+static void set_small_string(json_value *entry, const char *string, size_t length)
 {
-    if (!out) return JSON_ERROR_NULL;
+    if (length)
+        memcpy(entry->small_string, string, length);
+    entry->small_string[SMALL_STRING_SIZE - 1] = (char)(SMALL_STRING_SIZE - 1 - length);
+    entry->small_string[length] = '\0';
+    entry->flags |= STRING_INLINE;
+}
 
-    json_value *entry = malloc(sizeof(json_value));
-    if (!entry) return JSON_ERROR_ALLOCATION;
+// Copies a string of the given length to the heap, adding its terminator.
+static char *copy_string(const char *string, size_t length)
+{
+    char *copy = length < SIZE_MAX ? malloc(length + 1) : NULL;
+    if (!copy) return NULL;
 
-    *entry = (json_value) {0};
-    entry->type = JSON_BOOL;
-    entry->boolean = value;
-    *out = entry;
-    return JSON_SUCCESS;
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
 }
 
-json_error json_number_create(double value, json_value **out)
+// --------------------
+// Document Arena
+// --------------------
+
+static const size_t ARENA_INITIAL_BLOCK_SIZE = 4 * 1024;
+static const size_t ARENA_MAX_BLOCK_SIZE = 1024 * 1024;
+
+// Block of memory handed out by the arena, chained to the previously allocated blocks.
+typedef struct arena_block {
+    struct arena_block *previous;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+} arena_block;
+
+// Documents own an arena from which parsed values are bump-allocated.
+struct json_document {
+    arena_block *current;
+    size_t next_block_size;
+};
+
+json_error json_document_create(json_document **out)
 {
     if (!out) return JSON_ERROR_NULL;
 
-    json_value *entry = malloc(sizeof(json_value));
-    if (!entry) return JSON_ERROR_ALLOCATION;
+    json_document *document = malloc(sizeof(json_document));
+    if (!document) return JSON_ERROR_ALLOCATION;
 
-    *entry = (json_value) {0};
-    entry->type = JSON_NUMBER;
-    entry->number = value;
-    *out = entry;
+    document->current = NULL;
+    document->next_block_size = ARENA_INITIAL_BLOCK_SIZE;
+    *out = document;
     return JSON_SUCCESS;
 }
 
-json_error json_string_create(const char *value, json_value **out)
+void json_document_free(json_document *document)
 {
-    if (!value || !out) return JSON_ERROR_NULL;
-
-    char *string_copy = strdup(value);
-    if (!string_copy) return JSON_ERROR_ALLOCATION;
+    if (!document) return;
 
-    json_value *entry = malloc(sizeof(json_value));
-    if (!entry)
+    arena_block *block = document->current;
+    while (block)
     {
-        free(string_copy);
-        return JSON_ERROR_ALLOCATION;
+        arena_block *previous = block->previous;
+        free(block);
+        block = previous;
     }
-    *entry = (json_value) {0};
-    entry->type = JSON_STRING;
-    entry->string = string_copy;
-    *out = entry;
-    return JSON_SUCCESS;
+    free(document);
 }
 
-json_error json_string_create_nocopy(char *value, json_value **out)
+// Allocates a new arena block able to hold at least size bytes.
+static arena_block *arena_new_block(json_document *document, size_t size)
 {
-    if (!value || !out) return JSON_ERROR_NULL;
-
-    json_value *entry = malloc(sizeof(json_value));
-    if (!entry) return JSON_ERROR_ALLOCATION;
-
-    *entry = (json_value) {0};
-    entry->type = JSON_STRING;
-    entry->string = value;
-    *out = entry;
-    return JSON_SUCCESS;
+    size_t block_size = document->next_block_size;
+    if (block_size < size)
+        block_size = size;
+    else if (document->next_block_size < ARENA_MAX_BLOCK_SIZE)
+        document->next_block_size *= 2;
+
+    arena_block *block = malloc(sizeof(arena_block) + block_size);
+    if (!block) return NULL;
+
+    block->size = block_size;
+    block->used = 0;
+    return block;
 }
 
-json_error json_array_create(json_value **out)
+// Allocates memory from the document arena. Alignment must be a power of two.
+static void *arena_allocate(json_document *document, size_t size, size_t alignment)
 {
-    if (!out) return JSON_ERROR_NULL;
+    arena_block *block = document->current;
+    if (block)
+    {
+        size_t offset = (block->used + alignment - 1) & ~(alignment - 1);
+        if (offset <= block->size && size <= block->size - offset)
+        {
+            block->used = offset + size;
+            return (char*)block->data + offset;
+        }
+    }
 
-    json_value *entry = malloc(sizeof(json_value));
-    if (!entry) return JSON_ERROR_ALLOCATION;
+    block = arena_new_block(document, size);
+    if (!block) return NULL;
 
-    json_array *array = malloc(sizeof(json_array));
-    if (!array)
+    // Oversized allocations get a block of their own, keeping the current block in use.
+    if (document->current && size > document->next_block_size / 2)
     {
-        free(entry);
-        return JSON_ERROR_ALLOCATION;
+        block->previous = document->current->previous;
+        document->current->previous = block;
+    }
+    else
+    {
+        block->previous = document->current;
+        document->current = block;
     }
 
-    *entry = (json_value) {0};
-    entry->type = JSON_ARRAY;
-    entry->array = array;
-    array->length = 0;
-    *out = entry;
-    return JSON_SUCCESS;
+    block->used = size;
+    return block->data;
 }
 
-json_error json_object_create(json_value **out)
-{
-    if (!out) return JSON_ERROR_NULL;
+// --------------------
+// Node Pool
+// --------------------
 
-    json_value *entry = malloc(sizeof(json_value));
-    if (!entry) return JSON_ERROR_ALLOCATION;
+// Blocks up to POOL_MAX_BLOCK_SIZE bytes are pooled in size classes POOL_GRANULARITY bytes apart.
+enum { POOL_GRANULARITY = 8, POOL_MAX_BLOCK_SIZE = 256, POOL_CLASSES = POOL_MAX_BLOCK_SIZE / POOL_GRANULARITY };
 
-    json_object *object = malloc(sizeof(json_object));
-    if (!object)
-    {
-        free(entry);
-        return JSON_ERROR_ALLOCATION;
-    }
+// Freed block waiting for reuse, chained to the other free blocks of its class.
+typedef struct pool_block {
+    struct pool_block *next;
+} pool_block;
 
-    object->size = 0;
-    object->keys = NULL;
-    *entry = (json_value) {0};
-    entry->type = JSON_OBJECT;
-    entry->object = object;
-    *out = entry;
-    return JSON_SUCCESS;
-}
+// Free lists of the values and container storage released by a thread, kept up to a limit.
+typedef struct node_pool {
+    pool_block *free[POOL_CLASSES];
+    size_t cached;
+    size_t limit;
+} node_pool;
 
-json_error json_clone(const json_value *entry, json_value **out)
-{
-    switch (entry->type)
-    {
-    case JSON_NULL:   return json_null_create(out);
-    case JSON_BOOL:   return json_bool_create(entry->boolean, out);
-    case JSON_NUMBER: return json_number_create(entry->number, out);
-    case JSON_STRING: return json_string_create(entry->string, out);
+static _Thread_local node_pool thread_pool;
 
-    case JSON_ARRAY:
-    {
-        json_value *new_entry = malloc(sizeof(json_value));
-        if (!new_entry) return JSON_ERROR_ALLOCATION;
+// Returns the size class of a pooled block.
+static size_t pool_class(size_t size)
+{
+    return size ? (size - 1) / POOL_GRANULARITY : 0;
+}
 
-        json_array *new_array = malloc(sizeof(json_array) + entry->array->length * sizeof(json_value*));
-        if (!new_array)
-        {
-            free(new_entry);
-            return JSON_ERROR_ALLOCATION;
-        }
+// Allocates a block of memory, reusing a freed block of the same class when the pool has one.
+// Pooled blocks are always allocated with the full size of their class, so that any block
+// of the class can be reused for them, whether the pool is enabled or not.
+static void *pool_allocate(size_t size)
+{
+    if (size > POOL_MAX_BLOCK_SIZE) return malloc(size);
 
-        new_entry->type = JSON_ARRAY;
-        new_entry->array = new_array;
-        new_array->length = entry->array->length;
+    size_t size_class = pool_class(size);
+    size_t block_size = (size_class + 1) * POOL_GRANULARITY;
+    pool_block *block = thread_pool.free[size_class];
+    if (!block) return malloc(block_size);
 
-        for (size_t i = 0; i < new_array->length; ++i)
-        {
-            json_value *cloned_entry;
-            json_error error = json_clone(entry->array->entry[i], &cloned_entry);
-            if (error)
-            {
-                json_free(new_entry);
-                return error;
-            }
-            new_array->entry[i] = cloned_entry;
-        }
+    thread_pool.free[size_class] = block->next;
+    thread_pool.cached -= block_size;
+    return block;
+}
 
-        *out = new_entry;
-        return JSON_SUCCESS;
-    }
+// Releases a block from pool_allocate, keeping it for reuse unless the pool is full.
+static void pool_release(void *memory, size_t size)
+{
+    if (!memory) return;
 
-    case JSON_OBJECT:
+    size_t size_class = pool_class(size);
+    size_t block_size = (size_class + 1) * POOL_GRANULARITY;
+    if (size > POOL_MAX_BLOCK_SIZE || thread_pool.limit - thread_pool.cached < block_size)
     {
-        json_value *new_entry = malloc(sizeof(json_value));
-        if (!new_entry) return JSON_ERROR_ALLOCATION;
-
-        json_object *new_object = malloc(sizeof(json_object) + entry->object->size * sizeof(json_value*));
-        if (!new_object)
-        {
-            free(new_entry);
-            return JSON_ERROR_ALLOCATION;
-        }
-
-        if (entry->object->size)
-        {
-            new_object->keys = malloc(entry->object->size * sizeof(char*));
-            if (!new_object->keys)
-            {
-                free(new_object);
-                free(new_entry);
-                return JSON_ERROR_ALLOCATION;
-            }
-        }
-        else
-            new_object->keys = NULL;
+        free(memory);
+        return;
+    }
 
-        new_entry->type = JSON_OBJECT;
-        new_entry->object = new_object;
-        new_object->size = entry->object->size;
+    pool_block *block = memory;
+    block->next = thread_pool.free[size_class];
+    thread_pool.free[size_class] = block;
+    thread_pool.cached += block_size;
+}
 
-        for (size_t i = 0; i < new_object->size; ++i)
-        {
-            new_object->keys[i] = strdup(entry->object->keys[i]);
-            if (!new_object->keys[i])
-            {
-                json_free(new_entry);
-                return JSON_ERROR_ALLOCATION;
-            }
+// Resizes a block from pool_allocate, like realloc.
+static void *pool_resize(void *memory, size_t size, size_t new_size)
+{
+    if (!memory) return pool_allocate(new_size);
+    if (size > POOL_MAX_BLOCK_SIZE && new_size > POOL_MAX_BLOCK_SIZE) return realloc(memory, new_size);
+    if (size <= POOL_MAX_BLOCK_SIZE && new_size <= POOL_MAX_BLOCK_SIZE && pool_class(size) == pool_class(new_size))
+        return memory;
 
-            json_value *cloned_entry;
-            json_error error = json_clone(entry->object->entry[i], &cloned_entry);
-            if (error)
-            {
-                json_free(new_entry);
-                return error;
-            }
-            new_object->entry[i] = cloned_entry;
-        }
+    void *resized = pool_allocate(new_size);
+    if (!resized) return NULL;
 
-        *out = new_entry;
-        return JSON_SUCCESS;
-    }
-    }
-    return JSON_ERROR_WRONG_TYPE;
+    memcpy(resized, memory, size < new_size ? size : new_size);
+    pool_release(memory, size);
+    return resized;
 }
 
-static void free_array(json_array *array)
+// Sizes of the storage of arrays and objects, pooled when small.
+static size_t array_storage_size(size_t capacity)
 {
-    for (size_t i = 0; i < array->length; ++i)
-        json_free(array->entry[i]);
-    free(array);
+    return sizeof(json_array) + capacity * sizeof(json_value*);
 }
 
-static void free_object(json_object *object)
+static size_t object_storage_size(size_t capacity)
 {
-    for (size_t i = 0; i < object->size; ++i)
-    {
-        free(object->keys[i]);
-        json_free(object->entry[i]);
-    }
-    free(object->keys);
-    free(object);
+    return sizeof(json_object) + capacity * sizeof(json_value*);
 }
 
-static void free_content(json_value *entry)
+void json_node_pool_set_limit(size_t bytes)
 {
-    switch (entry->type)
+    thread_pool.limit = bytes;
+    for (size_t size_class = 0; size_class < POOL_CLASSES && thread_pool.cached > bytes; ++size_class)
     {
-    case JSON_STRING: free(entry->string);        return;
-    case JSON_ARRAY:  free_array(entry->array);   return;
-    case JSON_OBJECT: free_object(entry->object); return;
-    default: return;
+        while (thread_pool.free[size_class] && thread_pool.cached > bytes)
+        {
+            pool_block *block = thread_pool.free[size_class];
+            thread_pool.free[size_class] = block->next;
+            thread_pool.cached -= (size_class + 1) * POOL_GRANULARITY;
+            free(block);
+        }
     }
 }
 
-void json_free(json_value *entry)
-{
-    if (!entry) return;
-    free_content(entry);
-    free(entry);
-}
-
 // --------------------
-// JSON Getter API
+// Object Key Index
 // --------------------
 
-json_error json_get_type(const json_value *entry, json_type *out)
+// Objects with at least this many members get a hash index of their keys.
+static const size_t OBJECT_INDEX_THRESHOLD = 16;
+
+// Hashes a key with FNV-1a.
+static size_t hash_key(const char *key)
 {
-    if (!entry) return JSON_ERROR_NULL;
-    *out = entry->type;
-    return JSON_SUCCESS;
+    uint64_t hash = UINT64_C(0xCBF29CE484222325);
+    for (; *key; ++key)
+        hash = (hash ^ (unsigned char)*key) * UINT64_C(0x100000001B3);
+    return (size_t)hash;
 }
 
-json_error json_bool_get(const json_value *entry, bool *out)
+// Returns the smallest index capacity keeping an index of the given size at most half full.
+static size_t object_index_capacity(size_t size)
 {
-    if (!entry || !out) return JSON_ERROR_NULL;
-    CHECK_TYPE(entry, JSON_BOOL);
-    *out = entry->boolean;
-    return JSON_SUCCESS;
+    size_t capacity = OBJECT_INDEX_THRESHOLD * 2;
+    while (capacity < size * 2)
+        capacity *= 2;
+    return capacity;
 }
 
-json_error json_number_get(const json_value *entry, double *out)
+// Records the position of a member in an index that has free slots.
+static void index_member(size_t *index, size_t capacity, const char *key, size_t position)
 {
-    if (!entry || !out) return JSON_ERROR_NULL;
-    CHECK_TYPE(entry, JSON_NUMBER);
-    *out = entry->number;
-    return JSON_SUCCESS;
+    size_t slot = hash_key(key) & (capacity - 1);
+    while (index[slot])
+        slot = (slot + 1) & (capacity - 1);
+    index[slot] = position + 1;
 }
 
-json_error json_string_get(const json_value *entry, const char **out)
+// Fills the index of an object with the positions of all its members.
+static void fill_object_index(json_object *object)
 {
-    if (!entry || !out) return JSON_ERROR_NULL;
-    CHECK_TYPE(entry, JSON_STRING);
-    *out = entry->string;
-    return JSON_SUCCESS;
+    memset(object->index, 0, object->index_capacity * sizeof(size_t));
+    for (size_t i = 0; i < object->size; ++i)
+        index_member(object->index, object->index_capacity, object->keys[i], i);
 }
 
-// --------------------
-// JSON Setter API
-// --------------------
-
-json_error json_set_as_null(json_value *entry)
+// Returns the slot of the index of an object recording the member at the given position.
+static size_t find_index_slot(const json_object *object, size_t position)
 {
-    if (!entry) return JSON_ERROR_NULL;
-    free_content(entry);
-    *entry = (json_value) {0};
-    entry->type = JSON_NULL;
-    return JSON_SUCCESS;
+    size_t mask = object->index_capacity - 1;
+    size_t slot = hash_key(object->keys[position]) & mask;
+    while (object->index[slot] != position + 1)
+        slot = (slot + 1) & mask;
+    return slot;
 }
 
-json_error json_set_as_bool(json_value *entry, bool value)
+// Removes the member at the given position from the index of an object, before its keys
+// are moved down. The following slots of its probe run shift back into the freed slot, so
+// lookups need no tombstones, then a pass over the slots decrements the positions of the
+// members after it, without hashing their keys again.
+static void unindex_member(json_object *object, size_t position)
 {
-    if (!entry) return JSON_ERROR_NULL;
-    free_content(entry);
-    *entry = (json_value) {0};
-    entry->type = JSON_BOOL;
-    entry->boolean = value;
-    return JSON_SUCCESS;
+    size_t *index = object->index;
+    size_t mask = object->index_capacity - 1;
+    size_t hole = find_index_slot(object, position);
+    for (size_t next = (hole + 1) & mask; index[next]; next = (next + 1) & mask)
+    {
+        // A member moves back unless its home slot lies between the hole and its slot.
+        size_t home = hash_key(object->keys[index[next] - 1]) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            index[hole] = index[next];
+            hole = next;
+        }
+    }
+    index[hole] = 0;
+
+    if (position + 1 == object->size)
+        return;
+    for (size_t slot = 0; slot <= mask; ++slot)
+        index[slot] -= index[slot] > position + 1;
 }
 
-json_error json_set_as_number(json_value *entry, double value)
+// Replaces the heap-allocated index of an object by one sized for its members. Small
+// objects, or objects whose index couldn't be allocated, are scanned instead.
+static void rebuild_object_index(json_object *object)
 {
-    if (!entry) return JSON_ERROR_NULL;
-    free_content(entry);
-    *entry = (json_value) {0};
-    entry->type = JSON_NUMBER;
-    entry->number = value;
-    return JSON_SUCCESS;
+    free(object->index);
+    object->index = NULL;
+    object->index_capacity = 0;
+    if (object->size < OBJECT_INDEX_THRESHOLD)
+        return;
+
+    size_t capacity = object_index_capacity(object->size);
+    object->index = malloc(capacity * sizeof(size_t));
+    if (!object->index)
+        return;
+
+    object->index_capacity = capacity;
+    fill_object_index(object);
 }
 
-json_error json_set_as_string(json_value *entry, const char *string)
+// Returns the position of the member with the given key and hash, or the size of the object.
+// Interned keys are found by their pointer before comparing characters.
+static size_t find_member_hashed(const json_object *object, const char *key, size_t hash)
 {
-    if (!entry || !string) return JSON_ERROR_NULL;
+    // Frozen objects are searched by bisection, for the first member with the key.
+    if (object->sorted)
+    {
+        size_t low = 0, high = object->size;
+        while (low < high)
+        {
+            size_t middle = low + (high - low) / 2;
+            if (strcmp(object->keys[object->sorted[middle]], key) < 0)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        if (low < object->size && !strcmp(object->keys[object->sorted[low]], key))
+            return object->sorted[low];
+        return object->size;
+    }
 
-    char *string_copy = strdup(string);
-    if (!string_copy) return JSON_ERROR_ALLOCATION;
+    if (object->index)
+    {
+        size_t mask = object->index_capacity - 1;
+        for (size_t slot = hash & mask; object->index[slot]; slot = (slot + 1) & mask)
+        {
+            size_t position = object->index[slot] - 1;
+            if (object->keys[position] == key || !strcmp(object->keys[position], key))
+                return position;
+        }
+        return object->size;
+    }
 
-    free_content(entry);
-    *entry = (json_value) {0};
-    entry->type = JSON_STRING;
-    entry->string = string_copy;
-    return JSON_SUCCESS;
+    size_t i = 0;
+    while (i < object->size && object->keys[i] != key && strcmp(object->keys[i], key))
+        ++i;
+    return i;
 }
 
-json_error json_set_as_string_nocopy(json_value *entry, char *string)
+// Returns the position of the member with the given key, or the size of the object.
+static size_t find_member(const json_object *object, const char *key)
 {
-    if (!entry || !string) return JSON_ERROR_NULL;
+    return find_member_hashed(object, key, object->index ? hash_key(key) : 0);
+}
 
-    free_content(entry);
-    *entry = (json_value) {0};
-    entry->type = JSON_STRING;
-    entry->string = string;
-    return JSON_SUCCESS;
+// Key of a member and its position, sorted to freeze objects.
+typedef struct sorted_member {
+    const char *key;
+    size_t position;
+} sorted_member;
+
+static int compare_sorted_members(const void *a, const void *b)
+{
+    const sorted_member *member_a = a, *member_b = b;
+    int order = strcmp(member_a->key, member_b->key);
+    if (order) return order;
+    return member_a->position < member_b->position ? -1 : member_a->position > member_b->position;
 }
 
-json_error json_set_as_array(json_value *entry)
+// Writes the member positions of an object ordered by key, and by position for equal keys.
+static bool sort_object_members(const json_object *object, size_t *sorted)
 {
-    if (!entry) return JSON_ERROR_NULL;
+    sorted_member *members = malloc(object->size * sizeof(sorted_member));
+    if (!members) return true;
 
-    json_array *array = malloc(sizeof(json_array));
-    if (!array) return JSON_ERROR_ALLOCATION;
+    for (size_t i = 0; i < object->size; ++i)
+        members[i] = (sorted_member) { object->keys[i], i };
+    qsort(members, object->size, sizeof(sorted_member), compare_sorted_members);
+    for (size_t i = 0; i < object->size; ++i)
+        sorted[i] = members[i].position;
 
-    free_content(entry);
-    *entry = (json_value) {0};
-    entry->type = JSON_ARRAY;
-    entry->array = array;
-    array->length = 0;
-    return JSON_SUCCESS;
+    free(members);
+    return false;
 }
 
-json_error json_set_as_object(json_value *entry)
+// Goes back from the sorted positions of a frozen heap object to an index, as members are added.
+static void thaw_object(json_object *object)
 {
-    if (!entry) return JSON_ERROR_NULL;
+    if (!object->sorted) return;
 
-    json_object *object = malloc(sizeof(json_object));
-    if (!object) return JSON_ERROR_ALLOCATION;
+    free(object->sorted);
+    object->sorted = NULL;
+    rebuild_object_index(object);
+}
 
-    free_content(entry);
-    object->size = 0;
-    object->keys = NULL;
-    *entry = (json_value) {0};
-    entry->type = JSON_OBJECT;
-    entry->object = object;
-    return JSON_SUCCESS;
+// Drops a removed position from the sorted positions of a frozen object, whose size is already updated.
+static void unsort_member(json_object *object, size_t position)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i <= object->size; ++i)
+    {
+        size_t sorted = object->sorted[i];
+        if (sorted != position)
+            object->sorted[kept++] = sorted > position ? sorted - 1 : sorted;
+    }
 }
 
 // --------------------
-// JSON Array API
+// Key Interning Pool
 // --------------------
 
-json_error json_array_length(const json_value *array, size_t *out)
-{
-    if (!array || !out) return JSON_ERROR_NULL;
-    CHECK_TYPE(array, JSON_ARRAY);
+static const size_t KEY_POOL_INITIAL_CAPACITY = 64;
+
+// Interned keys are stored in an arena, each preceded by its hash, and found through
+// an open addressing table of their pointers. Interning is serialized by a spinlock,
+// the keys themselves never move nor change and can be read without locking.
+struct json_key_pool {
+    json_document *storage;
+    char **slots;
+    size_t count;
+    size_t capacity;
+#ifdef JSON_HAS_ATOMICS
+    atomic_flag lock;
+#endif
+};
 
-    *out = array->array->length;
-    return JSON_SUCCESS;
+static void lock_key_pool(json_key_pool *pool)
+{
+#ifdef JSON_HAS_ATOMICS
+    while (atomic_flag_test_and_set_explicit(&pool->lock, memory_order_acquire))
+        ;
+#else
+    (void)pool;
+#endif
 }
 
-json_error json_array_get(const json_value *array, size_t index, json_value **out)
+static void unlock_key_pool(json_key_pool *pool)
 {
-    if (!array || !out) return JSON_ERROR_NULL;
-    CHECK_TYPE(array, JSON_ARRAY);
-    if (index >= array->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
-
-    *out = array->array->entry[index];
-    return JSON_SUCCESS;
+#ifdef JSON_HAS_ATOMICS
+    atomic_flag_clear_explicit(&pool->lock, memory_order_release);
+#else
+    (void)pool;
+#endif
 }
 
-json_error json_array_set(json_value *array, size_t index, json_value *value)
+// Returns the hash stored in front of an interned key.
+static size_t interned_key_hash(const char *key)
 {
-    if (!array || !value) return JSON_ERROR_NULL;
-    CHECK_TYPE(array, JSON_ARRAY);
-    if (index >= array->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
-
-    json_value **array_slot = &array->array->entry[index];
-    json_free(*array_slot);
-    *array_slot = value;
-    return JSON_SUCCESS;
+    size_t hash;
+    memcpy(&hash, key - sizeof(size_t), sizeof(size_t));
+    return hash;
 }
 
-json_error json_array_append(json_value *array, json_value *value)
+json_error json_key_pool_create(json_key_pool **out)
 {
-    if (!array || !value) return JSON_ERROR_NULL;
-    CHECK_TYPE(array, JSON_ARRAY);
+    if (!out) return JSON_ERROR_NULL;
 
-    json_array *new_array = realloc(array->array, sizeof(json_array) + (array->array->length + 1) * sizeof(json_value*));
-    if (!new_array) return JSON_ERROR_ALLOCATION;
+    json_key_pool *pool = malloc(sizeof(json_key_pool));
+    char **slots = calloc(KEY_POOL_INITIAL_CAPACITY, sizeof(char*));
+    json_document *storage = NULL;
+    if (!pool || !slots || json_document_create(&storage))
+    {
+        free(slots);
+        free(pool);
+        return JSON_ERROR_ALLOCATION;
+    }
 
-    array->array = new_array;
-    new_array->entry[new_array->length++] = value;
+    pool->storage = storage;
+    pool->slots = slots;
+    pool->count = 0;
+    pool->capacity = KEY_POOL_INITIAL_CAPACITY;
+#ifdef JSON_HAS_ATOMICS
+    atomic_flag_clear(&pool->lock);
+#endif
+    *out = pool;
     return JSON_SUCCESS;
 }
 
-json_error json_array_insert(json_value *array, size_t index, json_value *value)
+void json_key_pool_free(json_key_pool *pool)
 {
-    if (!array || !value) return JSON_ERROR_NULL;
-    CHECK_TYPE(array, JSON_ARRAY);
-    if (index > array->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
+    if (!pool) return;
+    json_document_free(pool->storage);
+    free(pool->slots);
+    free(pool);
+}
 
-    json_array *new_array = realloc(array->array, sizeof(json_array) + (array->array->length + 1) * sizeof(json_value*));
-    if (!new_array) return JSON_ERROR_ALLOCATION;
+// Doubles the table of a key pool, returns true on allocation failure.
+static bool grow_key_pool(json_key_pool *pool)
+{
+    size_t capacity = pool->capacity * 2;
+    char **slots = calloc(capacity, sizeof(char*));
+    if (!slots) return true;
 
-    if (index < new_array->length)
-        memmove(new_array->entry + index + 1, new_array->entry + index, (new_array->length - index) * sizeof(json_value*));
-    new_array->entry[index] = value;
-    new_array->length++;
-    return JSON_SUCCESS;
+    for (size_t i = 0; i < pool->capacity; ++i)
+    {
+        char *key = pool->slots[i];
+        if (!key) continue;
+
+        size_t slot = interned_key_hash(key) & (capacity - 1);
+        while (slots[slot])
+            slot = (slot + 1) & (capacity - 1);
+        slots[slot] = key;
+    }
+
+    free(pool->slots);
+    pool->slots = slots;
+    pool->capacity = capacity;
+    return false;
 }
 
-json_error json_array_remove(json_value *array_value, size_t index, json_value **out)
+// Returns the canonical pointer of a key, adding it to the pool if needed, or NULL
+// on allocation failure.
+static char *intern_key(json_key_pool *pool, const char *key)
 {
-    if (!array_value) return JSON_ERROR_NULL;
-    CHECK_TYPE(array_value, JSON_ARRAY);
-    if (index >= array_value->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
+    size_t hash = hash_key(key);
+    char *interned = NULL;
+    lock_key_pool(pool);
 
-    json_value *removed = array_value->array->entry[index];
-    if (index < array_value->array->length - 1)
-        memmove(array_value->array->entry + index, array_value->array->entry + index + 1, (array_value->array->length - index - 1) * sizeof(json_value*));
+    size_t mask = pool->capacity - 1;
+    size_t slot = hash & mask;
+    for (; pool->slots[slot]; slot = (slot + 1) & mask)
+    {
+        if (interned_key_hash(pool->slots[slot]) == hash && !strcmp(pool->slots[slot], key))
+        {
+            interned = pool->slots[slot];
+            goto done;
+        }
+    }
 
-    array_value->array->length--;
+    // The table is kept at most half full.
+    if ((pool->count + 1) * 2 > pool->capacity)
+    {
+        if (grow_key_pool(pool)) goto done;
+        mask = pool->capacity - 1;
+        for (slot = hash & mask; pool->slots[slot]; slot = (slot + 1) & mask)
+            ;
+    }
 
-    if (out)
-        *out = removed;
-    else
-        json_free(removed);
+    size_t length = strlen(key);
+    char *memory = arena_allocate(pool->storage, sizeof(size_t) + length + 1, _Alignof(size_t));
+    if (!memory) goto done;
 
+    memcpy(memory, &hash, sizeof(size_t));
+    interned = memory + sizeof(size_t);
+    memcpy(interned, key, length + 1);
+    pool->slots[slot] = interned;
+    pool->count++;
+
+done:
+    unlock_key_pool(pool);
+    return interned;
+}
+
+json_error json_key_intern(json_key_pool *pool, const char *key, const char **out)
+{
+    if (!pool || !key || !out) return JSON_ERROR_NULL;
+
+    char *interned = intern_key(pool, key);
+    if (!interned) return JSON_ERROR_ALLOCATION;
+
+    *out = interned;
     return JSON_SUCCESS;
 }
 
 // --------------------
-// JSON Object API
+// JSON Creation API
 // --------------------
 
-json_error json_object_size(const json_value *object, size_t *out)
+json_error json_null_create(json_value **out)
 {
-    if (!object || !out) return JSON_ERROR_NULL;
-    CHECK_TYPE(object, JSON_OBJECT);
+    if (!out) return JSON_ERROR_NULL;
 
-    *out = object->object->size;
+    json_value *entry = pool_allocate(sizeof(json_value));
+    if (!entry) return JSON_ERROR_ALLOCATION;
+
+    *entry = (json_value) {0};
+    entry->type = JSON_NULL;
+    *out = entry;
     return JSON_SUCCESS;
 }
 
-json_error json_object_has_key(const json_value *object, const char *key, bool *out)
+json_error json_bool_create(bool value, json_value **out)
 {
-    if (!object || !key || !out) return JSON_ERROR_NULL;
-    CHECK_TYPE(object, JSON_OBJECT);
+    if (!out) return JSON_ERROR_NULL;
 
-    for (size_t i = 0; i < object->object->size; ++i)
-    {
-        if (!strcmp(object->object->keys[i], key))
-        {
-            *out = true;
-            return JSON_SUCCESS;
-        }
-    }
+    json_value *entry = pool_allocate(sizeof(json_value));
+    if (!entry) return JSON_ERROR_ALLOCATION;
 
-    *out = false;
+    *entry = (json_value) {0};
+    entry->type = JSON_BOOL;
+    entry->boolean = value;
+    *out = entry;
     return JSON_SUCCESS;
 }
 
-json_error json_object_get(const json_value *object, const char *key, json_value **out)
+json_error json_number_create(double value, json_value **out)
 {
-    if (!object || !key || !out) return JSON_ERROR_NULL;
-    CHECK_TYPE(object, JSON_OBJECT);
+    if (!out) return JSON_ERROR_NULL;
 
-    for (size_t i = 0; i < object->object->size; ++i)
-    {
-        if (!strcmp(object->object->keys[i], key))
-        {
-            *out = object->object->entry[i];
-            return JSON_SUCCESS;
-        }
-    }
+    json_value *entry = pool_allocate(sizeof(json_value));
+    if (!entry) return JSON_ERROR_ALLOCATION;
 
-    return JSON_ERROR_KEY_NOT_FOUND;
+    *entry = (json_value) {0};
+    entry->type = JSON_NUMBER;
+    entry->number = value;
+    *out = entry;
+    return JSON_SUCCESS;
 }
 
-json_error json_object_set(json_value *object, const char *key, json_value *value)
+json_error json_integer_create(int64_t value, json_value **out)
 {
-    if (!object || !key || !value) return JSON_ERROR_NULL;
-    CHECK_TYPE(object, JSON_OBJECT);
-
-    for (size_t i = 0; i < object->object->size; ++i)
-    {
-        if (!strcmp(object->object->keys[i], key))
-        {
-            json_free(object->object->entry[i]);
-            object->object->entry[i] = value;
-            return JSON_SUCCESS;
-        }
-    }
+    json_error error = json_number_create(0, out);
+    if (error) return error;
 
-    char *key_copy = strdup(key);
-    if (!key_copy) return JSON_ERROR_ALLOCATION;
+    (*out)->flags = NUMBER_INT64;
+    (*out)->integer = value;
+    return JSON_SUCCESS;
+}
 
-    json_object *new_object = realloc(object->object, sizeof(json_object) + (object->object->size + 1) * sizeof(json_value*));
-    if (!new_object)
-    {
-        free(key_copy);
-        return JSON_ERROR_ALLOCATION;
-    }
-    object->object = new_object;
+json_error json_unsigned_create(uint64_t value, json_value **out)
+{
+    if (value <= INT64_MAX)
+        return json_integer_create((int64_t)value, out);
 
-    char **new_keys = realloc(new_object->keys, (object->object->size + 1) * sizeof(char*));
-    if (!new_keys)
-    {
-        free(key_copy);
-        return JSON_ERROR_ALLOCATION;
-    }
+    json_error error = json_number_create(0, out);
+    if (error) return error;
 
-    new_keys[new_object->size] = key_copy;
-    new_object->keys = new_keys;
-    new_object->entry[object->object->size] = value;
-    new_object->size++;
+    (*out)->flags = NUMBER_UINT64;
+    (*out)->unsigned_integer = value;
     return JSON_SUCCESS;
 }
 
-json_error json_object_remove(json_value *object, const char *key, json_value **out)
+json_error json_string_create(const char *value, json_value **out)
 {
-    if (!object || !key) return JSON_ERROR_NULL;
-    CHECK_TYPE(object, JSON_OBJECT);
-
-    for (size_t i = 0; i < object->object->size; ++i)
-    {
-        char *old_key = object->object->keys[i];
-        if (strcmp(old_key, key))
-            continue;
-        free(old_key);
-        
-        json_value *removed = object->object->entry[i];
-        if (i < object->object->size - 1)
-        {
-            memmove(object->object->keys + i, object->object->keys + i + 1, (object->object->size - i - 1) * sizeof(char*));
-            memmove(object->object->entry + i, object->object->entry + i + 1, (object->object->size - i - 1) * sizeof(json_value*));
-        }
+    if (!value || !out) return JSON_ERROR_NULL;
+    return json_string_create_len(value, strlen(value), out);
+}
 
-        object->object->size--;
+json_error json_string_create_len(const char *value, size_t length, json_value **out)
+{
+    if (!value || !out) return JSON_ERROR_NULL;
 
-        if (out)
-            *out = removed;
-        else
-            json_free(removed);
+    if (length < SMALL_STRING_SIZE)
+    {
+        json_value *entry = pool_allocate(sizeof(json_value));
+        if (!entry) return JSON_ERROR_ALLOCATION;
 
+        *entry = (json_value) {0};
+        entry->type = JSON_STRING;
+        set_small_string(entry, value, length);
+        *out = entry;
         return JSON_SUCCESS;
     }
 
-    return JSON_ERROR_KEY_NOT_FOUND;
-}
-
-// ----------
-// JSON Parsing
-// ----------
-
-const json_parse_options JSON_DEFAULT_PARSE_OPTIONS = {
-    .error_info = NULL,
-    .max_depth = DEFAULT_MAX_DEPTH
-};
-
-typedef struct json_parser {
-    const json_parse_options *options;
-    json_error_info *error_info;
+    char *string_copy = copy_string(value, length);
+    if (!string_copy) return JSON_ERROR_ALLOCATION;
 
-    union
+    json_value *entry = pool_allocate(sizeof(json_value));
+    if (!entry)
     {
-        FILE *input_file;
-        const char *input_string;
-    };
-    int (*getc)(struct json_parser *parser);
-    
-    size_t line, column;
-    size_t depth;
-    int last_c;
-    json_error error;
-} json_parser;
+        free(string_copy);
+        return JSON_ERROR_ALLOCATION;
+    }
+    *entry = (json_value) {0};
+    entry->type = JSON_STRING;
+    entry->string = string_copy;
+    entry->string_length = length;
+    *out = entry;
+    return JSON_SUCCESS;
+}
 
-// Reports a parsing error at the current location.
-static void report_parsing_error(json_parser *parser, json_error error_type, const char *error_fmt, ...)
+json_error json_string_create_nocopy(char *value, json_value **out)
 {
-    parser->error = error_type;
+    if (!value || !out) return JSON_ERROR_NULL;
 
-    if (!parser->error_info) return;
-    parser->error_info->line = parser->line;
-    parser->error_info->column = parser->column;
-    parser->error_info->error = error_type;
+    json_value *entry = pool_allocate(sizeof(json_value));
+    if (!entry) return JSON_ERROR_ALLOCATION;
 
-    va_list args, args_copy;
-    va_start(args, error_fmt);
+    *entry = (json_value) {0};
+    entry->type = JSON_STRING;
+    entry->string = value;
+    entry->string_length = strlen(value);
+    *out = entry;
+    return JSON_SUCCESS;
+}
 
-    va_copy(args_copy, args);
-    int size = vsnprintf(NULL, 0, error_fmt, args_copy);
-    va_end(args_copy);
-    if (size < 0)
+json_error json_array_create(json_value **out)
+{
+    if (!out) return JSON_ERROR_NULL;
+
+    json_value *entry = pool_allocate(sizeof(json_value));
+    if (!entry) return JSON_ERROR_ALLOCATION;
+
+    json_array *array = pool_allocate(array_storage_size(0));
+    if (!array)
     {
-        va_end(args);
-        strcpy(parser->error_info->message, "invalid error message format");
-        return;
+        pool_release(entry, sizeof(json_value));
+        return JSON_ERROR_ALLOCATION;
     }
 
-    vsnprintf(parser->error_info->message, 256, error_fmt, args);
-    va_end(args);
+    *entry = (json_value) {0};
+    entry->type = JSON_ARRAY;
+    entry->array = array;
+    *array = (json_array) {0};
+    *out = entry;
+    return JSON_SUCCESS;
 }
 
-static bool parse_entry(json_parser *parser, json_value **out);
-
-// Reads the next character and updates line/column.
-static void consume(json_parser *parser)
+json_error json_object_create(json_value **out)
 {
-    if (parser->last_c == EOF) return;
-    parser->last_c = parser->getc(parser);
+    if (!out) return JSON_ERROR_NULL;
 
-    if (parser->last_c == '\n')
+    json_value *entry = pool_allocate(sizeof(json_value));
+    if (!entry) return JSON_ERROR_ALLOCATION;
+
+    json_object *object = pool_allocate(object_storage_size(0));
+    if (!object)
     {
-        parser->line++;
-        parser->column = 0;
+        pool_release(entry, sizeof(json_value));
+        return JSON_ERROR_ALLOCATION;
     }
-    else
-        parser->column++;
+
+    *object = (json_object) {0};
+    *entry = (json_value) {0};
+    entry->type = JSON_OBJECT;
+    entry->object = object;
+    *out = entry;
+    return JSON_SUCCESS;
 }
 
-// Skips whitespace characters.
-static void skip_blank(json_parser *parser)
+static json_error copy_value(const json_value *entry, json_value **out);
+
+// Clones a member of a container, sharing it rather than copying it when it is itself
+// a container of a shared tree.
+static json_error clone_member(const json_value *member, shared_tree *tree, json_value **out)
 {
-    while (isspace(parser->last_c) && parser->last_c != EOF)
-        consume(parser);
+    if (tree && (member->type == JSON_ARRAY || member->type == JSON_OBJECT))
+        return share_content(tree, member, out);
+    return copy_value(member, out);
 }
 
-// Verifies that the next character is as expected. If not, reports error.
-static bool expect(json_parser *parser, char expected_c)
+// Copies an array or object, cloning its members, or sharing those that are containers
+// of the given tree.
+static json_error clone_container(const json_value *entry, shared_tree *tree, json_value **out)
 {
-    if (parser->last_c != expected_c)
+    switch (entry->type)
     {
-        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER,
-            "expected '%c', found '%c'", expected_c, parser->last_c);
-        return true;
+    case JSON_ARRAY:
+    {
+        json_value *new_entry = pool_allocate(sizeof(json_value));
+        if (!new_entry) return JSON_ERROR_ALLOCATION;
+
+        json_array *new_array = pool_allocate(array_storage_size(entry->array->length));
+        if (!new_array)
+        {
+            pool_release(new_entry, sizeof(json_value));
+            return JSON_ERROR_ALLOCATION;
+        }
+
+        *new_entry = (json_value) {0};
+        new_entry->type = JSON_ARRAY;
+        new_entry->array = new_array;
+        new_array->length = 0;
+        new_array->capacity = entry->array->length;
+
+        for (size_t i = 0; i < entry->array->length; ++i)
+        {
+            json_value *cloned_entry;
+            json_error error = clone_member(entry->array->entry[i], tree, &cloned_entry);
+            if (error)
+            {
+                json_free(new_entry);
+                return error;
+            }
+            new_array->entry[new_array->length++] = cloned_entry;
+        }
+
+        *out = new_entry;
+        return JSON_SUCCESS;
     }
 
-    consume(parser);
-    skip_blank(parser);
-    return false;
+    case JSON_OBJECT:
+    {
+        json_value *new_entry = pool_allocate(sizeof(json_value));
+        if (!new_entry) return JSON_ERROR_ALLOCATION;
+
+        json_object *new_object = pool_allocate(object_storage_size(entry->object->size));
+        if (!new_object)
+        {
+            pool_release(new_entry, sizeof(json_value));
+            return JSON_ERROR_ALLOCATION;
+        }
+
+        if (entry->object->size)
+        {
+            new_object->keys = malloc(entry->object->size * sizeof(char*));
+            if (!new_object->keys)
+            {
+                pool_release(new_object, object_storage_size(entry->object->size));
+                pool_release(new_entry, sizeof(json_value));
+                return JSON_ERROR_ALLOCATION;
+            }
+        }
+        else
+            new_object->keys = NULL;
+
+        *new_entry = (json_value) {0};
+        new_entry->type = JSON_OBJECT;
+        new_entry->object = new_object;
+        new_object->size = 0;
+        new_object->capacity = entry->object->size;
+        new_object->index = NULL;
+        new_object->sorted = NULL;
+
+        for (size_t i = 0; i < entry->object->size; ++i)
+        {
+            char *key_copy = strdup(entry->object->keys[i]);
+            if (!key_copy)
+            {
+                json_free(new_entry);
+                return JSON_ERROR_ALLOCATION;
+            }
+
+            json_value *cloned_entry;
+            json_error error = clone_member(entry->object->entry[i], tree, &cloned_entry);
+            if (error)
+            {
+                free(key_copy);
+                json_free(new_entry);
+                return error;
+            }
+            new_object->keys[i] = key_copy;
+            new_object->entry[i] = cloned_entry;
+            new_object->size++;
+        }
+
+        // Frozen objects stay frozen if their positions can be copied, and are indexed otherwise.
+        if (entry->object->sorted)
+            new_object->sorted = malloc(new_object->size * sizeof(size_t));
+        if (new_object->sorted)
+            memcpy(new_object->sorted, entry->object->sorted, new_object->size * sizeof(size_t));
+        else
+            rebuild_object_index(new_object);
+        *out = new_entry;
+        return JSON_SUCCESS;
+    }
+    default: return JSON_ERROR_WRONG_TYPE;
+    }
 }
 
-// Builds and returns a string from characters matching a predicate.
-static bool get_string(json_parser *parser, bool (*predicate)(int c), char **out)
+// Copies a value and the values it holds, sharing the containers that are already shared.
+static json_error copy_value(const json_value *entry, json_value **out)
 {
-    string_builder builder = {0};
+    if (entry->flags & SHARED_CONTENT)
+        return share_content(entry->shared->tree, entry->shared->content, out);
+    if ((entry->flags & SHARED_NODE) && (entry->type == JSON_ARRAY || entry->type == JSON_OBJECT))
+        return share_content(entry->tree, entry, out);
 
-    while (predicate(parser->last_c))
+    RESOLVE_CONTENT(entry);
+    switch (entry->type)
     {
-        if (string_builder_append(&builder, parser->last_c))
-            goto alloc_error;
-        consume(parser);
+    case JSON_NULL:   return json_null_create(out);
+    case JSON_BOOL:   return json_bool_create(entry->boolean, out);
+    case JSON_NUMBER:
+        if (entry->flags & NUMBER_INT64) return json_integer_create(entry->integer, out);
+        if (entry->flags & NUMBER_UINT64) return json_unsigned_create(entry->unsigned_integer, out);
+        return json_number_create(entry->number, out);
+    case JSON_STRING: return json_string_create_len(string_text(entry), string_length(entry), out);
+
+    case JSON_ARRAY:
+    case JSON_OBJECT: return clone_container(entry, NULL, out);
     }
+    return JSON_ERROR_WRONG_TYPE;
+}
 
-    skip_blank(parser);
+// Frees the elements of an array, and the array itself unless the arena owns it.
+static void free_array(json_array *array, bool in_arena)
+{
+    for (size_t i = 0; i < array->length; ++i)
+        json_free(array->entry[i]);
+    if (!in_arena)
+        pool_release(array, array_storage_size(array->capacity));
+}
 
-    char *string;
-    if (string_builder_build(&builder, &string))
-        goto alloc_error;
+// Frees the values of an object, and its keys and storage unless they are not owned.
+static void free_object(json_object *object, bool in_arena, bool owns_keys)
+{
+    for (size_t i = 0; i < object->size; ++i)
+    {
+        if (owns_keys)
+            free(object->keys[i]);
+        json_free(object->entry[i]);
+    }
+    if (in_arena)
+        return;
+    free(object->index);
+    free(object->sorted);
+    free(object->keys);
+    pool_release(object, object_storage_size(object->capacity));
+}
 
-    *out = string;
-    return false;
+// Frees the parsed value of a deferred container, and the container itself and its
+// share of the input unless the arena owns them.
+static void free_lazy(lazy_container *lazy, bool in_arena)
+{
+    json_free(lazy->value);
+    if (in_arena)
+        return;
+    if (--lazy->source->references == 0)
+        free(lazy->source);
+    free(lazy);
+}
 
-alloc_error:
-    string_builder_free(&builder);
-    report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't reallocate string buffer");
-    return true;
+static void retain_shared_tree(shared_tree *tree)
+{
+#ifdef JSON_HAS_ATOMICS
+    atomic_fetch_add_explicit(&tree->references, 1, memory_order_relaxed);
+#else
+    tree->references++;
+#endif
 }
 
-// Converts a hexadecimal digit to its value. Returns -1 if invalid.
-static int hex_digit_to_value(char c)
+// Frees a shared tree once no container shares it anymore.
+static void release_shared_tree(shared_tree *tree)
 {
-    if ('0' <= c && c <= '9') return c - '0';
-    if ('a' <= c && c <= 'f') return c - 'a' + 10;
-    if ('A' <= c && c <= 'F') return c - 'A' + 10;
-    return -1;
+#ifdef JSON_HAS_ATOMICS
+    if (atomic_fetch_sub_explicit(&tree->references, 1, memory_order_acq_rel) != 1)
+        return;
+#else
+    if (--tree->references != 0)
+        return;
+#endif
+    free_content(&tree->root);
+    free(tree);
 }
 
-// Parses 4 hexadecimal digits into a UTF-16 code unit.
-static bool parse_utf16_code_unit(json_parser *parser, uint32_t *out)
+static void free_shared(shared_container *shared)
 {
-    uint32_t code_point = 0;
-    for (size_t i = 0; i < 4; ++i)
+    release_shared_tree(shared->tree);
+    free(shared);
+}
+
+static void free_content(json_value *entry)
+{
+    bool in_arena = entry->flags & CONTENT_IN_ARENA;
+    bool owns_text = !(entry->flags & (CONTENT_IN_ARENA | TEXT_BORROWED | STRING_INLINE));
+    if (entry->flags & LAZY_CONTENT)
     {
-        int digit = hex_digit_to_value(parser->last_c);
-        if (digit < 0)
+        free_lazy(entry->lazy, in_arena);
+        return;
+    }
+    if (entry->flags & SHARED_CONTENT)
+    {
+        free_shared(entry->shared);
+        return;
+    }
+
+    switch (entry->type)
+    {
+    case JSON_STRING: if (owns_text) free(entry->string); return;
+    case JSON_ARRAY:  free_array(entry->array, in_arena); return;
+    case JSON_OBJECT: free_object(entry->object, in_arena, owns_text); return;
+    default: return;
+    }
+}
+
+// Frees the content of a value and resets it to the given type,
+// keeping track of where the value itself was allocated.
+static void reset_value(json_value *entry, json_type type)
+{
+    free_content(entry);
+    uint16_t flags = entry->flags & VALUE_IN_ARENA;
+    *entry = (json_value) {0};
+    entry->type = type;
+    entry->flags = flags;
+}
+
+void json_free(json_value *entry)
+{
+    if (!entry) return;
+    free_content(entry);
+    if (!(entry->flags & VALUE_IN_ARENA))
+        pool_release(entry, sizeof(json_value));
+}
+
+// Gives the value holding the array or object of a container, parsing it on first
+// access when a lazy parse deferred it, and reading the tree when it is shared.
+static json_error resolve_content(const json_value **entry)
+{
+    while ((*entry)->flags & (LAZY_CONTENT | SHARED_CONTENT))
+    {
+        if ((*entry)->flags & SHARED_CONTENT)
         {
-            report_parsing_error(parser, JSON_ERROR_UNICODE, "invalid hexadecimal digit '%c'", parser->last_c);
-            return true;
+            *entry = (*entry)->shared->content;
+            continue;
         }
-        code_point = (code_point << 4) | digit;
-        consume(parser);
+
+        lazy_container *lazy = (*entry)->lazy;
+        if (!lazy->value)
+        {
+            json_error error = parse_deferred(lazy, NULL);
+            if (error) return error;
+        }
+        *entry = lazy->value;
     }
-    *out = code_point;
-    return false;
+    return JSON_SUCCESS;
 }
 
-// Parses Unicode escape sequences, including surrogate pairs.
-static bool parse_utf16_escape(json_parser *parser, uint32_t *out)
+// Moves the parsed array or object of a deferred container into it, or gives a shared
+// one its own copy of the array or object of the tree, so it can be modified. The copy
+// shares the containers it holds in turn.
+static json_error materialize_content(json_value *entry)
 {
-    uint32_t code_point;
-    if (parse_utf16_code_unit(parser, &code_point)) return true;
+    CHECK_WRITABLE(entry);
+
+    json_value *parsed;
+    if (entry->flags & SHARED_CONTENT)
+    {
+        shared_container *shared = entry->shared;
+        const json_value *content = shared->content;
+        json_error error = resolve_content(&content);
+        if (!error)
+            error = clone_container(content, shared->tree, &parsed);
+        if (error) return error;
+        free_shared(shared);
+    }
+    else if (entry->flags & LAZY_CONTENT)
+    {
+        lazy_container *lazy = entry->lazy;
+        if (!lazy->value)
+        {
+            json_error error = parse_deferred(lazy, NULL);
+            if (error) return error;
+        }
+
+        parsed = lazy->value;
+        lazy->value = NULL;
+        free_lazy(lazy, entry->flags & CONTENT_IN_ARENA);
+    }
+    else
+        return JSON_SUCCESS;
+
+    entry->flags = (entry->flags & VALUE_IN_ARENA) | (parsed->flags & ~VALUE_IN_ARENA);
+    if (entry->type == JSON_ARRAY)
+        entry->array = parsed->array;
+    else
+        entry->object = parsed->object;
+    if (!(parsed->flags & VALUE_IN_ARENA))
+        pool_release(parsed, sizeof(json_value));
+    return JSON_SUCCESS;
+}
+
+// Marks the values of a tree read-only, down to the containers shared from other trees,
+// its arrays and objects recording the tree so that they can be shared in turn.
+static void seal_shared_tree(json_value *entry, shared_tree *tree)
+{
+    entry->flags |= SHARED_NODE;
+    if (entry->flags & SHARED_CONTENT) return;
+
+    if (entry->type == JSON_ARRAY)
+    {
+        entry->tree = tree;
+        for (size_t i = 0; i < entry->array->length; ++i)
+            seal_shared_tree(entry->array->entry[i], tree);
+    }
+    else if (entry->type == JSON_OBJECT)
+    {
+        entry->tree = tree;
+        for (size_t i = 0; i < entry->object->size; ++i)
+            seal_shared_tree(entry->object->entry[i], tree);
+    }
+}
+
+// Creates a container sharing an array or object of a tree.
+static json_error share_content(shared_tree *tree, const json_value *content, json_value **out)
+{
+    json_value *entry = pool_allocate(sizeof(json_value));
+    shared_container *shared = malloc(sizeof(shared_container));
+    if (!entry || !shared)
+    {
+        free(shared);
+        pool_release(entry, sizeof(json_value));
+        return JSON_ERROR_ALLOCATION;
+    }
+
+    retain_shared_tree(tree);
+    *shared = (shared_container) {
+        .tree = tree,
+        .content = content
+    };
+    *entry = (json_value) {0};
+    entry->type = content->type;
+    entry->flags = SHARED_CONTENT;
+    entry->shared = shared;
+    *out = entry;
+    return JSON_SUCCESS;
+}
+
+json_error json_clone(const json_value *entry, json_value **out)
+{
+    if (!entry || !out) return JSON_ERROR_NULL;
+    // Containers sharing a tree, and the values of a tree, share it with the clone.
+    if (entry->flags & (SHARED_CONTENT | SHARED_NODE) || (entry->type != JSON_ARRAY && entry->type != JSON_OBJECT))
+        return copy_value(entry, out);
+
+    // The source stays its own, it is copied once into a tree that its clone and the
+    // clones of the clone share. Containers parsed lazily are parsed in the copy.
+    json_value *copy;
+    json_error error = copy_value(entry, &copy);
+    if (error) return error;
+
+    shared_tree *tree = malloc(sizeof(shared_tree));
+    if (!tree)
+    {
+        json_free(copy);
+        return JSON_ERROR_ALLOCATION;
+    }
+
+#ifdef JSON_HAS_ATOMICS
+    atomic_init(&tree->references, 1);
+#else
+    tree->references = 1;
+#endif
+    tree->root = *copy;
+    pool_release(copy, sizeof(json_value));
+    seal_shared_tree(&tree->root, tree);
+
+    // The clone holds the only reference once the one of the copy is released.
+    error = share_content(tree, &tree->root, out);
+    release_shared_tree(tree);
+    return error;
+}
+
+// Moves the storage of an arena-backed array to the heap so it can be resized.
+static bool detach_array_from_arena(json_value *array_value)
+{
+    if (!(array_value->flags & CONTENT_IN_ARENA)) return false;
+
+    size_t size = array_storage_size(array_value->array->length);
+    json_array *array = pool_allocate(size);
+    if (!array) return true;
+
+    memcpy(array, array_value->array, size);
+    array->capacity = array->length;
+    array_value->array = array;
+    array_value->flags &= ~CONTENT_IN_ARENA;
+    return false;
+}
+
+// Moves the storage and keys of an arena-backed object to the heap so it can be resized.
+static bool detach_object_from_arena(json_value *object_value)
+{
+    if (!(object_value->flags & CONTENT_IN_ARENA)) return false;
+
+    json_object *arena_object = object_value->object;
+    size_t size = object_storage_size(arena_object->size);
+    json_object *object = pool_allocate(size);
+    char **keys = arena_object->size ? malloc(arena_object->size * sizeof(char*)) : NULL;
+    if (!object || (arena_object->size && !keys))
+        goto alloc_error;
+
+    // Borrowed keys stay borrowed, only keys allocated in the arena are copied.
+    bool borrowed = object_value->flags & TEXT_BORROWED;
+    for (size_t i = 0; i < arena_object->size; ++i)
+    {
+        keys[i] = borrowed ? arena_object->keys[i] : strdup(arena_object->keys[i]);
+        if (!keys[i])
+        {
+            while (i--)
+                free(keys[i]);
+            goto alloc_error;
+        }
+    }
+
+    memcpy(object, arena_object, size);
+    object->capacity = object->size;
+    object->keys = keys;
+    object->index = NULL;
+    object->sorted = NULL;
+
+    // Frozen objects stay frozen if their positions can be copied, and are indexed otherwise.
+    if (arena_object->sorted)
+        object->sorted = malloc(object->size * sizeof(size_t));
+    if (object->sorted)
+        memcpy(object->sorted, arena_object->sorted, object->size * sizeof(size_t));
+    else
+        rebuild_object_index(object);
+    object_value->object = object;
+    object_value->flags &= ~CONTENT_IN_ARENA;
+    return false;
+
+alloc_error:
+    free(keys);
+    pool_release(object, size);
+    return true;
+}
+
+// Copies the keys an object borrows from a buffer parsed in situ or a key pool, so that it owns all its keys.
+static bool own_object_keys(json_value *object_value)
+{
+    if (!(object_value->flags & TEXT_BORROWED)) return false;
+
+    json_object *object = object_value->object;
+    char **keys = object->capacity ? malloc(object->capacity * sizeof(char*)) : NULL;
+    if (object->capacity && !keys)
+        return true;
+
+    for (size_t i = 0; i < object->size; ++i)
+    {
+        keys[i] = strdup(object->keys[i]);
+        if (!keys[i])
+        {
+            while (i--)
+                free(keys[i]);
+            free(keys);
+            return true;
+        }
+    }
+
+    free(object->keys);
+    object->keys = keys;
+    object_value->flags &= ~TEXT_BORROWED;
+    return false;
+}
+
+// Resizes the heap storage of an array to hold capacity values.
+static bool resize_array(json_value *array_value, size_t capacity)
+{
+    if (capacity > (SIZE_MAX - sizeof(json_array)) / sizeof(json_value*)) return true;
+
+    json_array *array = pool_resize(array_value->array, array_storage_size(array_value->array->capacity), array_storage_size(capacity));
+    if (!array) return true;
+
+    array->capacity = capacity;
+    array_value->array = array;
+    return false;
+}
+
+// Makes room for one more value in an array, growing its storage geometrically.
+static bool grow_array(json_value *array_value)
+{
+    if (detach_array_from_arena(array_value)) return true;
+
+    json_array *array = array_value->array;
+    if (array->length < array->capacity) return false;
+    return resize_array(array_value, array->capacity ? array->capacity * 2 : INITIAL_CONTAINER_CAPACITY);
+}
+
+// Resizes the keys of an object to hold capacity members.
+static bool resize_object_keys(json_object *object, size_t capacity)
+{
+    if (capacity == 0)
+    {
+        free(object->keys);
+        object->keys = NULL;
+        return false;
+    }
+
+    char **keys = realloc(object->keys, capacity * sizeof(char*));
+    if (!keys) return true;
+
+    object->keys = keys;
+    return false;
+}
+
+// Resizes the heap storage and keys of an object to hold capacity members.
+static bool resize_object(json_value *object_value, size_t capacity)
+{
+    if (capacity > (SIZE_MAX - sizeof(json_object)) / sizeof(json_value*)) return true;
+
+    // The keys grow first and shrink last, so that they always have room for capacity members.
+    bool growing = capacity > object_value->object->capacity;
+    if (growing && resize_object_keys(object_value->object, capacity)) return true;
+
+    json_object *object = pool_resize(object_value->object, object_storage_size(object_value->object->capacity), object_storage_size(capacity));
+    if (!object) return true;
+
+    object->capacity = capacity;
+    object_value->object = object;
+    if (!growing)
+        resize_object_keys(object, capacity);
+    return false;
+}
+
+// Makes room for one more member in an object, growing its storage geometrically.
+static bool grow_object(json_value *object_value)
+{
+    if (detach_object_from_arena(object_value) || own_object_keys(object_value)) return true;
+
+    json_object *object = object_value->object;
+    if (object->size < object->capacity) return false;
+    return resize_object(object_value, object->capacity ? object->capacity * 2 : INITIAL_CONTAINER_CAPACITY);
+}
+
+// --------------------
+// JSON Getter API
+// --------------------
+
+json_error json_get_type(const json_value *entry, json_type *out)
+{
+    if (!entry) return JSON_ERROR_NULL;
+    *out = entry->type;
+    return JSON_SUCCESS;
+}
+
+json_error json_bool_get(const json_value *entry, bool *out)
+{
+    if (!entry || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(entry, JSON_BOOL);
+    *out = entry->boolean;
+    return JSON_SUCCESS;
+}
+
+json_error json_number_get(const json_value *entry, double *out)
+{
+    if (!entry || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(entry, JSON_NUMBER);
+    if (entry->flags & NUMBER_INT64)
+        *out = (double)entry->integer;
+    else if (entry->flags & NUMBER_UINT64)
+        *out = (double)entry->unsigned_integer;
+    else
+        *out = entry->number;
+    return JSON_SUCCESS;
+}
+
+json_error json_integer_get(const json_value *entry, int64_t *out)
+{
+    if (!entry || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(entry, JSON_NUMBER);
+    if (entry->flags & NUMBER_INT64)
+    {
+        *out = entry->integer;
+        return JSON_SUCCESS;
+    }
+    if (entry->flags & NUMBER_UINT64)
+        return JSON_ERROR_OUT_OF_RANGE;
+
+    // The range check comes first, converting an out of range double is undefined.
+    double number = entry->number;
+    if (!(number >= -0x1p63 && number < 0x1p63) || (double)(int64_t)number != number)
+        return JSON_ERROR_OUT_OF_RANGE;
+    *out = (int64_t)number;
+    return JSON_SUCCESS;
+}
+
+json_error json_unsigned_get(const json_value *entry, uint64_t *out)
+{
+    if (!entry || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(entry, JSON_NUMBER);
+    if (entry->flags & NUMBER_INT64)
+    {
+        if (entry->integer < 0) return JSON_ERROR_OUT_OF_RANGE;
+        *out = (uint64_t)entry->integer;
+        return JSON_SUCCESS;
+    }
+    if (entry->flags & NUMBER_UINT64)
+    {
+        *out = entry->unsigned_integer;
+        return JSON_SUCCESS;
+    }
+
+    double number = entry->number;
+    if (!(number >= 0 && number < 0x1p64) || (double)(uint64_t)number != number)
+        return JSON_ERROR_OUT_OF_RANGE;
+    *out = (uint64_t)number;
+    return JSON_SUCCESS;
+}
+
+json_error json_string_get(const json_value *entry, const char **out)
+{
+    if (!entry || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(entry, JSON_STRING);
+    *out = string_text(entry);
+    return JSON_SUCCESS;
+}
+
+json_error json_string_get_len(const json_value *entry, const char **out, size_t *length)
+{
+    if (!entry || !out || !length) return JSON_ERROR_NULL;
+    CHECK_TYPE(entry, JSON_STRING);
+    *out = string_text(entry);
+    *length = string_length(entry);
+    return JSON_SUCCESS;
+}
+
+// --------------------
+// JSON Setter API
+// --------------------
+
+json_error json_set_as_null(json_value *entry)
+{
+    if (!entry) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+    reset_value(entry, JSON_NULL);
+    return JSON_SUCCESS;
+}
+
+json_error json_set_as_bool(json_value *entry, bool value)
+{
+    if (!entry) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+    reset_value(entry, JSON_BOOL);
+    entry->boolean = value;
+    return JSON_SUCCESS;
+}
+
+json_error json_set_as_number(json_value *entry, double value)
+{
+    if (!entry) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+    reset_value(entry, JSON_NUMBER);
+    entry->number = value;
+    return JSON_SUCCESS;
+}
+
+json_error json_set_as_integer(json_value *entry, int64_t value)
+{
+    if (!entry) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+    reset_value(entry, JSON_NUMBER);
+    entry->flags |= NUMBER_INT64;
+    entry->integer = value;
+    return JSON_SUCCESS;
+}
+
+json_error json_set_as_unsigned(json_value *entry, uint64_t value)
+{
+    if (!entry) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+    if (value <= INT64_MAX)
+        return json_set_as_integer(entry, (int64_t)value);
+
+    reset_value(entry, JSON_NUMBER);
+    entry->flags |= NUMBER_UINT64;
+    entry->unsigned_integer = value;
+    return JSON_SUCCESS;
+}
+
+json_error json_set_as_string(json_value *entry, const char *string)
+{
+    if (!entry || !string) return JSON_ERROR_NULL;
+    return json_set_as_string_len(entry, string, strlen(string));
+}
+
+json_error json_set_as_string_len(json_value *entry, const char *string, size_t length)
+{
+    if (!entry || !string) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+
+    // The string may be the current one of the value, it is copied before the reset.
+    if (length < SMALL_STRING_SIZE)
+    {
+        char small_string[SMALL_STRING_SIZE];
+        memcpy(small_string, string, length);
+        reset_value(entry, JSON_STRING);
+        set_small_string(entry, small_string, length);
+        return JSON_SUCCESS;
+    }
+
+    char *string_copy = copy_string(string, length);
+    if (!string_copy) return JSON_ERROR_ALLOCATION;
+
+    reset_value(entry, JSON_STRING);
+    entry->string = string_copy;
+    entry->string_length = length;
+    return JSON_SUCCESS;
+}
+
+json_error json_set_as_string_nocopy(json_value *entry, char *string)
+{
+    if (!entry || !string) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+
+    reset_value(entry, JSON_STRING);
+    entry->string = string;
+    entry->string_length = strlen(string);
+    return JSON_SUCCESS;
+}
+
+json_error json_set_as_array(json_value *entry)
+{
+    if (!entry) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+
+    json_array *array = pool_allocate(array_storage_size(0));
+    if (!array) return JSON_ERROR_ALLOCATION;
+
+    reset_value(entry, JSON_ARRAY);
+    entry->array = array;
+    *array = (json_array) {0};
+    return JSON_SUCCESS;
+}
+
+json_error json_set_as_object(json_value *entry)
+{
+    if (!entry) return JSON_ERROR_NULL;
+    CHECK_WRITABLE(entry);
+
+    json_object *object = pool_allocate(object_storage_size(0));
+    if (!object) return JSON_ERROR_ALLOCATION;
+
+    reset_value(entry, JSON_OBJECT);
+    *object = (json_object) {0};
+    entry->object = object;
+    return JSON_SUCCESS;
+}
+
+// --------------------
+// JSON Array API
+// --------------------
+
+json_error json_array_length(const json_value *array, size_t *out)
+{
+    if (!array || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(array, JSON_ARRAY);
+    RESOLVE_CONTENT(array);
+
+    *out = array->array->length;
+    return JSON_SUCCESS;
+}
+
+json_error json_array_get(const json_value *array, size_t index, json_value **out)
+{
+    if (!array || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(array, JSON_ARRAY);
+    RESOLVE_CONTENT(array);
+    if (index >= array->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
+
+    *out = array->array->entry[index];
+    return JSON_SUCCESS;
+}
+
+json_error json_array_get_mutable(json_value *array, size_t index, json_value **out)
+{
+    if (!array || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(array, JSON_ARRAY);
+    MATERIALIZE_CONTENT(array);
+    if (index >= array->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
+
+    *out = array->array->entry[index];
+    return JSON_SUCCESS;
+}
+
+json_error json_array_set(json_value *array, size_t index, json_value *value)
+{
+    if (!array || !value) return JSON_ERROR_NULL;
+    CHECK_TYPE(array, JSON_ARRAY);
+    MATERIALIZE_CONTENT(array);
+    if (index >= array->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
+
+    json_value **array_slot = &array->array->entry[index];
+    json_free(*array_slot);
+    *array_slot = value;
+    return JSON_SUCCESS;
+}
+
+json_error json_array_append(json_value *array, json_value *value)
+{
+    if (!array || !value) return JSON_ERROR_NULL;
+    CHECK_TYPE(array, JSON_ARRAY);
+    MATERIALIZE_CONTENT(array);
+    if (grow_array(array)) return JSON_ERROR_ALLOCATION;
+
+    array->array->entry[array->array->length++] = value;
+    return JSON_SUCCESS;
+}
+
+json_error json_array_insert(json_value *array, size_t index, json_value *value)
+{
+    if (!array || !value) return JSON_ERROR_NULL;
+    CHECK_TYPE(array, JSON_ARRAY);
+    MATERIALIZE_CONTENT(array);
+    if (index > array->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
+    if (grow_array(array)) return JSON_ERROR_ALLOCATION;
+
+    json_array *new_array = array->array;
+    if (index < new_array->length)
+        memmove(new_array->entry + index + 1, new_array->entry + index, (new_array->length - index) * sizeof(json_value*));
+    new_array->entry[index] = value;
+    new_array->length++;
+    return JSON_SUCCESS;
+}
+
+json_error json_array_remove(json_value *array_value, size_t index, json_value **out)
+{
+    if (!array_value) return JSON_ERROR_NULL;
+    CHECK_TYPE(array_value, JSON_ARRAY);
+    MATERIALIZE_CONTENT(array_value);
+    if (index >= array_value->array->length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
+
+    json_value *removed = array_value->array->entry[index];
+    if (index < array_value->array->length - 1)
+        memmove(array_value->array->entry + index, array_value->array->entry + index + 1, (array_value->array->length - index - 1) * sizeof(json_value*));
+
+    array_value->array->length--;
+
+    if (out)
+        *out = removed;
+    else
+        json_free(removed);
+
+    return JSON_SUCCESS;
+}
+
+json_error json_array_reserve(json_value *array, size_t capacity)
+{
+    if (!array) return JSON_ERROR_NULL;
+    CHECK_TYPE(array, JSON_ARRAY);
+    MATERIALIZE_CONTENT(array);
+    if (capacity <= array->array->capacity) return JSON_SUCCESS;
+
+    if (detach_array_from_arena(array) || resize_array(array, capacity)) return JSON_ERROR_ALLOCATION;
+    return JSON_SUCCESS;
+}
+
+json_error json_array_shrink_to_fit(json_value *array)
+{
+    if (!array) return JSON_ERROR_NULL;
+    CHECK_TYPE(array, JSON_ARRAY);
+    MATERIALIZE_CONTENT(array);
+
+    // Arena storage is allocated for the exact length and isn't freed on its own.
+    if ((array->flags & CONTENT_IN_ARENA) || array->array->length == array->array->capacity)
+        return JSON_SUCCESS;
+
+    if (resize_array(array, array->array->length)) return JSON_ERROR_ALLOCATION;
+    return JSON_SUCCESS;
+}
+
+// --------------------
+// JSON Object API
+// --------------------
+
+json_error json_object_size(const json_value *object, size_t *out)
+{
+    if (!object || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    RESOLVE_CONTENT(object);
+
+    *out = object->object->size;
+    return JSON_SUCCESS;
+}
+
+json_error json_object_has_key(const json_value *object, const char *key, bool *out)
+{
+    if (!object || !key || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    RESOLVE_CONTENT(object);
+
+    *out = find_member(object->object, key) < object->object->size;
+    return JSON_SUCCESS;
+}
+
+json_error json_object_get(const json_value *object, const char *key, json_value **out)
+{
+    if (!object || !key || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    RESOLVE_CONTENT(object);
+
+    size_t position = find_member(object->object, key);
+    if (position == object->object->size) return JSON_ERROR_KEY_NOT_FOUND;
+
+    *out = object->object->entry[position];
+    return JSON_SUCCESS;
+}
+
+json_error json_object_get_mutable(json_value *object, const char *key, json_value **out)
+{
+    if (!object || !key || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    MATERIALIZE_CONTENT(object);
+
+    size_t position = find_member(object->object, key);
+    if (position == object->object->size) return JSON_ERROR_KEY_NOT_FOUND;
+
+    *out = object->object->entry[position];
+    return JSON_SUCCESS;
+}
+
+json_error json_object_set(json_value *object, const char *key, json_value *value)
+{
+    if (!object || !key || !value) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    MATERIALIZE_CONTENT(object);
+
+    size_t position = find_member(object->object, key);
+    if (position < object->object->size)
+    {
+        json_free(object->object->entry[position]);
+        object->object->entry[position] = value;
+        return JSON_SUCCESS;
+    }
+
+    if (grow_object(object)) return JSON_ERROR_ALLOCATION;
+    thaw_object(object->object);
+
+    char *key_copy = strdup(key);
+    if (!key_copy) return JSON_ERROR_ALLOCATION;
+
+    json_object *new_object = object->object;
+    new_object->keys[new_object->size] = key_copy;
+    new_object->entry[new_object->size] = value;
+    new_object->size++;
+
+    if (new_object->index && new_object->size * 2 <= new_object->index_capacity)
+        index_member(new_object->index, new_object->index_capacity, key_copy, new_object->size - 1);
+    else if (new_object->size >= OBJECT_INDEX_THRESHOLD)
+        rebuild_object_index(new_object);
+    return JSON_SUCCESS;
+}
+
+json_error json_object_get_interned(const json_value *object, const char *key, json_value **out)
+{
+    if (!object || !key || !out) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    RESOLVE_CONTENT(object);
+
+    size_t position = find_member_hashed(object->object, key, interned_key_hash(key));
+    if (position == object->object->size) return JSON_ERROR_KEY_NOT_FOUND;
+
+    *out = object->object->entry[position];
+    return JSON_SUCCESS;
+}
+
+json_error json_object_set_interned(json_value *object, const char *key, json_value *value)
+{
+    if (!object || !key || !value) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    MATERIALIZE_CONTENT(object);
+
+    size_t hash = interned_key_hash(key);
+    size_t position = find_member_hashed(object->object, key, hash);
+    if (position < object->object->size)
+    {
+        json_free(object->object->entry[position]);
+        object->object->entry[position] = value;
+        return JSON_SUCCESS;
+    }
+
+    // Objects owning copies of their keys get a copy of this one too.
+    if (!object->object->size)
+        object->flags |= TEXT_BORROWED;
+    bool borrow = object->flags & TEXT_BORROWED;
+    if (detach_object_from_arena(object)) return JSON_ERROR_ALLOCATION;
+
+    json_object *new_object = object->object;
+    if (new_object->size == new_object->capacity &&
+        resize_object(object, new_object->capacity ? new_object->capacity * 2 : INITIAL_CONTAINER_CAPACITY))
+        return JSON_ERROR_ALLOCATION;
+    thaw_object(object->object);
+
+    // The pool hands out keys as const, borrowed keys are never written nor freed.
+    char *key_copy = borrow ? (char*)(uintptr_t)key : strdup(key);
+    if (!key_copy) return JSON_ERROR_ALLOCATION;
+
+    new_object = object->object;
+    new_object->keys[new_object->size] = key_copy;
+    new_object->entry[new_object->size] = value;
+    new_object->size++;
+
+    if (new_object->index && new_object->size * 2 <= new_object->index_capacity)
+        index_member(new_object->index, new_object->index_capacity, key_copy, new_object->size - 1);
+    else if (new_object->size >= OBJECT_INDEX_THRESHOLD)
+        rebuild_object_index(new_object);
+    return JSON_SUCCESS;
+}
+
+json_error json_object_remove(json_value *object, const char *key, json_value **out)
+{
+    if (!object || !key) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    MATERIALIZE_CONTENT(object);
+
+    size_t i = find_member(object->object, key);
+    if (i == object->object->size) return JSON_ERROR_KEY_NOT_FOUND;
+
+    // The index is updated while the keys are still at their positions.
+    if (object->object->index)
+        unindex_member(object->object, i);
+
+    if (!(object->flags & (CONTENT_IN_ARENA | TEXT_BORROWED)))
+        free(object->object->keys[i]);
+
+    json_value *removed = object->object->entry[i];
+    if (i < object->object->size - 1)
+    {
+        memmove(object->object->keys + i, object->object->keys + i + 1, (object->object->size - i - 1) * sizeof(char*));
+        memmove(object->object->entry + i, object->object->entry + i + 1, (object->object->size - i - 1) * sizeof(json_value*));
+    }
+
+    object->object->size--;
+    if (object->object->sorted)
+        unsort_member(object->object, i);
+
+    if (out)
+        *out = removed;
+    else
+        json_free(removed);
+
+    return JSON_SUCCESS;
+}
+
+json_error json_object_freeze(json_value *object)
+{
+    if (!object) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    MATERIALIZE_CONTENT(object);
+    if (object->object->sorted || object->object->size < OBJECT_INDEX_THRESHOLD) return JSON_SUCCESS;
+
+    // The sorted positions are allocated on the heap, with the rest of the object.
+    if (detach_object_from_arena(object)) return JSON_ERROR_ALLOCATION;
+
+    json_object *frozen = object->object;
+    size_t *sorted = malloc(frozen->size * sizeof(size_t));
+    if (!sorted || sort_object_members(frozen, sorted))
+    {
+        free(sorted);
+        return JSON_ERROR_ALLOCATION;
+    }
+
+    free(frozen->index);
+    frozen->index = NULL;
+    frozen->index_capacity = 0;
+    frozen->sorted = sorted;
+    return JSON_SUCCESS;
+}
+
+json_error json_object_reserve(json_value *object, size_t capacity)
+{
+    if (!object) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    MATERIALIZE_CONTENT(object);
+    if (capacity <= object->object->capacity) return JSON_SUCCESS;
+
+    if (detach_object_from_arena(object) || resize_object(object, capacity)) return JSON_ERROR_ALLOCATION;
+    return JSON_SUCCESS;
+}
+
+json_error json_object_shrink_to_fit(json_value *object)
+{
+    if (!object) return JSON_ERROR_NULL;
+    CHECK_TYPE(object, JSON_OBJECT);
+    MATERIALIZE_CONTENT(object);
+    if (object->flags & CONTENT_IN_ARENA) return JSON_SUCCESS;
+
+    if (object->object->size != object->object->capacity && resize_object(object, object->object->size))
+        return JSON_ERROR_ALLOCATION;
+
+    // The index may have been sized for members removed since.
+    if (object->object->index)
+        rebuild_object_index(object->object);
+    return JSON_SUCCESS;
+}
+
+// ----------
+// Number Conversion
+// ----------
+
+// A decimal number decomposed as mantissa * 10^exponent, keeping at most 19
+// significant digits in the mantissa.
+typedef struct decimal_number {
+    uint64_t mantissa;
+    int64_t exponent;
+    bool negative;
+    bool truncated; // Non-zero digits were dropped from the mantissa.
+    bool integer;   // No fraction or exponent part.
+} decimal_number;
+
+static const int MAX_MANTISSA_DIGITS = 19;
+static const int64_t MAX_EXPONENT_DIGITS_VALUE = 100000;
+
+static inline bool is_digit(int c)
+{
+    return '0' <= c && c <= '9';
+}
+
+// Validates the JSON number grammar over the whole of [data, end), and decomposes
+// the number. Returns true if the characters aren't a valid JSON number.
+static bool scan_decimal_number(const char *data, const char *end, decimal_number *out)
+{
+    *out = (decimal_number) {.integer = true};
+    int digits = 0;
+
+    if (data != end && *data == '-')
+    {
+        out->negative = true;
+        data++;
+    }
+
+    // Integer part, where a leading zero must stand alone.
+    if (data == end || !is_digit(*data)) return true;
+    if (*data == '0')
+        data++;
+    else for (; data != end && is_digit(*data); ++data)
+    {
+        if (digits < MAX_MANTISSA_DIGITS)
+        {
+            out->mantissa = out->mantissa * 10 + (*data - '0');
+            digits++;
+        }
+        else
+        {
+            out->truncated |= *data != '0';
+            out->exponent++;
+        }
+    }
+
+    if (data != end && *data == '.')
+    {
+        out->integer = false;
+        data++;
+        if (data == end || !is_digit(*data)) return true;
+        for (; data != end && is_digit(*data); ++data)
+        {
+            // Leading zeros of the fraction only shift the exponent.
+            if (digits == 0 && *data == '0')
+                out->exponent--;
+            else if (digits < MAX_MANTISSA_DIGITS)
+            {
+                out->mantissa = out->mantissa * 10 + (*data - '0');
+                out->exponent--;
+                digits++;
+            }
+            else
+                out->truncated |= *data != '0';
+        }
+    }
+
+    if (data != end && (*data == 'e' || *data == 'E'))
+    {
+        out->integer = false;
+        data++;
+        bool negative_exponent = false;
+        if (data != end && (*data == '+' || *data == '-'))
+            negative_exponent = *data++ == '-';
+        if (data == end || !is_digit(*data)) return true;
+
+        // Larger exponents all overflow or underflow anyway.
+        int64_t exponent = 0;
+        for (; data != end && is_digit(*data); ++data)
+            if (exponent < MAX_EXPONENT_DIGITS_VALUE)
+                exponent = exponent * 10 + (*data - '0');
+        out->exponent += negative_exponent ? -exponent : exponent;
+    }
+
+    return data != end;
+}
+
+// 128-bit approximations of the powers of five from 5^-342 to 5^324, normalized so
+// that the most significant bit is set (most significant half first). They are rounded
+// up from 5^-27 to 5^-1, and down otherwise.
+#define POWER_OF_FIVE_MIN (-342)
+#define POWER_OF_FIVE_MAX 324
+static const uint64_t POWERS_OF_FIVE[][2] = {
+    {0xeef453d6923bd65a, 0x113faa2906a13b3f},
+    {0x9558b4661b6565f8, 0x4ac7ca59a424c507},
+    {0xbaaee17fa23ebf76, 0x5d79bcf00d2df649},
+    {0xe95a99df8ace6f53, 0xf4d82c2c107973dc},
+    {0x91d8a02bb6c10594, 0x79071b9b8a4be869},
+    {0xb64ec836a47146f9, 0x9748e2826cdee284},
+    {0xe3e27a444d8d98b7, 0xfd1b1b2308169b25},
+    {0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7},
+    {0xb208ef855c969f4f, 0xbdbd2d335e51a935},
+    {0xde8b2b66b3bc4723, 0xad2c788035e61382},
+    {0x8b16fb203055ac76, 0x4c3bcb5021afcc31},
+    {0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d},
+    {0xd953e8624b85dd78, 0xd71d6dad34a2af0d},
+    {0x87d4713d6f33aa6b, 0x8672648c40e5ad68},
+    {0xa9c98d8ccb009506, 0x680efdaf511f18c2},
+    {0xd43bf0effdc0ba48, 0x0212bd1b2566def2},
+    {0x84a57695fe98746d, 0x014bb630f7604b57},
+    {0xa5ced43b7e3e9188, 0x419ea3bd35385e2d},
+    {0xcf42894a5dce35ea, 0x52064cac828675b9},
+    {0x818995ce7aa0e1b2, 0x7343efebd1940993},
+    {0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8},
+    {0xca66fa129f9b60a6, 0xd41a26e077774ef6},
+    {0xfd00b897478238d0, 0x8920b098955522b4},
+    {0x9e20735e8cb16382, 0x55b46e5f5d5535b0},
+    {0xc5a890362fddbc62, 0xeb2189f734aa831d},
+    {0xf712b443bbd52b7b, 0xa5e9ec7501d523e4},
+    {0x9a6bb0aa55653b2d, 0x47b233c92125366e},
+    {0xc1069cd4eabe89f8, 0x999ec0bb696e840a},
+    {0xf148440a256e2c76, 0xc00670ea43ca250d},
+    {0x96cd2a865764dbca, 0x380406926a5e5728},
+    {0xbc807527ed3e12bc, 0xc605083704f5ecf2},
+    {0xeba09271e88d976b, 0xf7864a44c633682e},
+    {0x93445b8731587ea3, 0x7ab3ee6afbe0211d},
+    {0xb8157268fdae9e4c, 0x5960ea05bad82964},
+    {0xe61acf033d1a45df, 0x6fb92487298e33bd},
+    {0x8fd0c16206306bab, 0xa5d3b6d479f8e056},
+    {0xb3c4f1ba87bc8696, 0x8f48a4899877186c},
+    {0xe0b62e2929aba83c, 0x331acdabfe94de87},
+    {0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14},
+    {0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9},
+    {0xdb71e91432b1a24a, 0xc9e82cd9f69d6150},
+    {0x892731ac9faf056e, 0xbe311c083a225cd2},
+    {0xab70fe17c79ac6ca, 0x6dbd630a48aaf406},
+    {0xd64d3d9db981787d, 0x092cbbccdad5b108},
+    {0x85f0468293f0eb4e, 0x25bbf56008c58ea5},
+    {0xa76c582338ed2621, 0xaf2af2b80af6f24e},
+    {0xd1476e2c07286faa, 0x1af5af660db4aee1},
+    {0x82cca4db847945ca, 0x50d98d9fc890ed4d},
+    {0xa37fce126597973c, 0xe50ff107bab528a0},
+    {0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8},
+    {0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a},
+    {0x9faacf3df73609b1, 0x77b191618c54e9ac},
+    {0xc795830d75038c1d, 0xd59df5b9ef6a2417},
+    {0xf97ae3d0d2446f25, 0x4b0573286b44ad1d},
+    {0x9becce62836ac577, 0x4ee367f9430aec32},
+    {0xc2e801fb244576d5, 0x229c41f793cda73f},
+    {0xf3a20279ed56d48a, 0x6b43527578c1110f},
+    {0x9845418c345644d6, 0x830a13896b78aaa9},
+    {0xbe5691ef416bd60c, 0x23cc986bc656d553},
+    {0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8},
+    {0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9},
+    {0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53},
+    {0xe858ad248f5c22c9, 0xd1b3400f8f9cff68},
+    {0x91376c36d99995be, 0x23100809b9c21fa1},
+    {0xb58547448ffffb2d, 0xabd40a0c2832a78a},
+    {0xe2e69915b3fff9f9, 0x16c90c8f323f516c},
+    {0x8dd01fad907ffc3b, 0xae3da7d97f6792e3},
+    {0xb1442798f49ffb4a, 0x99cd11cfdf41779c},
+    {0xdd95317f31c7fa1d, 0x40405643d711d583},
+    {0x8a7d3eef7f1cfc52, 0x482835ea666b2572},
+    {0xad1c8eab5ee43b66, 0xda3243650005eecf},
+    {0xd863b256369d4a40, 0x90bed43e40076a82},
+    {0x873e4f75e2224e68, 0x5a7744a6e804a291},
+    {0xa90de3535aaae202, 0x711515d0a205cb36},
+    {0xd3515c2831559a83, 0x0d5a5b44ca873e03},
+    {0x8412d9991ed58091, 0xe858790afe9486c2},
+    {0xa5178fff668ae0b6, 0x626e974dbe39a872},
+    {0xce5d73ff402d98e3, 0xfb0a3d212dc8128f},
+    {0x80fa687f881c7f8e, 0x7ce66634bc9d0b99},
+    {0xa139029f6a239f72, 0x1c1fffc1ebc44e80},
+    {0xc987434744ac874e, 0xa327ffb266b56220},
+    {0xfbe9141915d7a922, 0x4bf1ff9f0062baa8},
+    {0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9},
+    {0xc4ce17b399107c22, 0xcb550fb4384d21d3},
+    {0xf6019da07f549b2b, 0x7e2a53a146606a48},
+    {0x99c102844f94e0fb, 0x2eda7444cbfc426d},
+    {0xc0314325637a1939, 0xfa911155fefb5308},
+    {0xf03d93eebc589f88, 0x793555ab7eba27ca},
+    {0x96267c7535b763b5, 0x4bc1558b2f3458de},
+    {0xbbb01b9283253ca2, 0x9eb1aaedfb016f16},
+    {0xea9c227723ee8bcb, 0x465e15a979c1cadc},
+    {0x92a1958a7675175f, 0x0bfacd89ec191ec9},
+    {0xb749faed14125d36, 0xcef980ec671f667b},
+    {0xe51c79a85916f484, 0x82b7e12780e7401a},
+    {0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810},
+    {0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15},
+    {0xdfbdcece67006ac9, 0x67a791e093e1d49a},
+    {0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0},
+    {0xaecc49914078536d, 0x58fae9f773886e18},
+    {0xda7f5bf590966848, 0xaf39a475506a899e},
+    {0x888f99797a5e012d, 0x6d8406c952429603},
+    {0xaab37fd7d8f58178, 0xc8e5087ba6d33b83},
+    {0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64},
+    {0x855c3be0a17fcd26, 0x5cf2eea09a55067f},
+    {0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e},
+    {0xd0601d8efc57b08b, 0xf13b94daf124da26},
+    {0x823c12795db6ce57, 0x76c53d08d6b70858},
+    {0xa2cb1717b52481ed, 0x54768c4b0c64ca6e},
+    {0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09},
+    {0xfe5d54150b090b02, 0xd3f93b35435d7c4c},
+    {0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf},
+    {0xc6b8e9b0709f109a, 0x359ab6419ca1091b},
+    {0xf867241c8cc6d4c0, 0xc30163d203c94b62},
+    {0x9b407691d7fc44f8, 0x79e0de63425dcf1d},
+    {0xc21094364dfb5636, 0x985915fc12f542e4},
+    {0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d},
+    {0x979cf3ca6cec5b5a, 0xa705992ceecf9c42},
+    {0xbd8430bd08277231, 0x50c6ff782a838353},
+    {0xece53cec4a314ebd, 0xa4f8bf5635246428},
+    {0x940f4613ae5ed136, 0x871b7795e136be99},
+    {0xb913179899f68584, 0x28e2557b59846e3f},
+    {0xe757dd7ec07426e5, 0x331aeada2fe589cf},
+    {0x9096ea6f3848984f, 0x3ff0d2c85def7621},
+    {0xb4bca50b065abe63, 0x0fed077a756b53a9},
+    {0xe1ebce4dc7f16dfb, 0xd3e8495912c62894},
+    {0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c},
+    {0xb080392cc4349dec, 0xbd8d794d96aacfb3},
+    {0xdca04777f541c567, 0xecf0d7a0fc5583a0},
+    {0x89e42caaf9491b60, 0xf41686c49db57244},
+    {0xac5d37d5b79b6239, 0x311c2875c522ced5},
+    {0xd77485cb25823ac7, 0x7d633293366b828b},
+    {0x86a8d39ef77164bc, 0xae5dff9c02033197},
+    {0xa8530886b54dbdeb, 0xd9f57f830283fdfc},
+    {0xd267caa862a12d66, 0xd072df63c324fd7b},
+    {0x8380dea93da4bc60, 0x4247cb9e59f71e6d},
+    {0xa46116538d0deb78, 0x52d9be85f074e608},
+    {0xcd795be870516656, 0x67902e276c921f8b},
+    {0x806bd9714632dff6, 0x00ba1cd8a3db53b6},
+    {0xa086cfcd97bf97f3, 0x80e8a40eccd228a4},
+    {0xc8a883c0fdaf7df0, 0x6122cd128006b2cd},
+    {0xfad2a4b13d1b5d6c, 0x796b805720085f81},
+    {0x9cc3a6eec6311a63, 0xcbe3303674053bb0},
+    {0xc3f490aa77bd60fc, 0xbedbfc4411068a9c},
+    {0xf4f1b4d515acb93b, 0xee92fb5515482d44},
+    {0x991711052d8bf3c5, 0x751bdd152d4d1c4a},
+    {0xbf5cd54678eef0b6, 0xd262d45a78a0635d},
+    {0xef340a98172aace4, 0x86fb897116c87c34},
+    {0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0},
+    {0xbae0a846d2195712, 0x8974836059cca109},
+    {0xe998d258869facd7, 0x2bd1a438703fc94b},
+    {0x91ff83775423cc06, 0x7b6306a34627ddcf},
+    {0xb67f6455292cbf08, 0x1a3bc84c17b1d542},
+    {0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93},
+    {0x8e938662882af53e, 0x547eb47b7282ee9c},
+    {0xb23867fb2a35b28d, 0xe99e619a4f23aa43},
+    {0xdec681f9f4c31f31, 0x6405fa00e2ec94d4},
+    {0x8b3c113c38f9f37e, 0xde83bc408dd3dd04},
+    {0xae0b158b4738705e, 0x9624ab50b148d445},
+    {0xd98ddaee19068c76, 0x3badd624dd9b0957},
+    {0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6},
+    {0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c},
+    {0xd47487cc8470652b, 0x7647c3200069671f},
+    {0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073},
+    {0xa5fb0a17c777cf09, 0xf468107100525890},
+    {0xcf79cc9db955c2cc, 0x7182148d4066eeb4},
+    {0x81ac1fe293d599bf, 0xc6f14cd848405530},
+    {0xa21727db38cb002f, 0xb8ada00e5a506a7c},
+    {0xca9cf1d206fdc03b, 0xa6d90811f0e4851c},
+    {0xfd442e4688bd304a, 0x908f4a166d1da663},
+    {0x9e4a9cec15763e2e, 0x9a598e4e043287fe},
+    {0xc5dd44271ad3cdba, 0x40eff1e1853f29fd},
+    {0xf7549530e188c128, 0xd12bee59e68ef47c},
+    {0x9a94dd3e8cf578b9, 0x82bb74f8301958ce},
+    {0xc13a148e3032d6e7, 0xe36a52363c1faf01},
+    {0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1},
+    {0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9},
+    {0xbcb2b812db11a5de, 0x7415d448f6b6f0e7},
+    {0xebdf661791d60f56, 0x111b495b3464ad21},
+    {0x936b9fcebb25c995, 0xcab10dd900beec34},
+    {0xb84687c269ef3bfb, 0x3d5d514f40eea742},
+    {0xe65829b3046b0afa, 0x0cb4a5a3112a5112},
+    {0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab},
+    {0xb3f4e093db73a093, 0x59ed216765690f56},
+    {0xe0f218b8d25088b8, 0x306869c13ec3532c},
+    {0x8c974f7383725573, 0x1e414218c73a13fb},
+    {0xafbd2350644eeacf, 0xe5d1929ef90898fa},
+    {0xdbac6c247d62a583, 0xdf45f746b74abf39},
+    {0x894bc396ce5da772, 0x6b8bba8c328eb783},
+    {0xab9eb47c81f5114f, 0x066ea92f3f326564},
+    {0xd686619ba27255a2, 0xc80a537b0efefebd},
+    {0x8613fd0145877585, 0xbd06742ce95f5f36},
+    {0xa798fc4196e952e7, 0x2c48113823b73704},
+    {0xd17f3b51fca3a7a0, 0xf75a15862ca504c5},
+    {0x82ef85133de648c4, 0x9a984d73dbe722fb},
+    {0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba},
+    {0xcc963fee10b7d1b3, 0x318df905079926a8},
+    {0xffbbcfe994e5c61f, 0xfdf17746497f7052},
+    {0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633},
+    {0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0},
+    {0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0},
+    {0x9c1661a651213e2d, 0x06bea10ca65c084e},
+    {0xc31bfa0fe5698db8, 0x486e494fcff30a62},
+    {0xf3e2f893dec3f126, 0x5a89dba3c3efccfa},
+    {0x986ddb5c6b3a76b7, 0xf89629465a75e01c},
+    {0xbe89523386091465, 0xf6bbb397f1135823},
+    {0xee2ba6c0678b597f, 0x746aa07ded582e2c},
+    {0x94db483840b717ef, 0xa8c2a44eb4571cdc},
+    {0xba121a4650e4ddeb, 0x92f34d62616ce413},
+    {0xe896a0d7e51e1566, 0x77b020baf9c81d17},
+    {0x915e2486ef32cd60, 0x0ace1474dc1d122e},
+    {0xb5b5ada8aaff80b8, 0x0d819992132456ba},
+    {0xe3231912d5bf60e6, 0x10e1fff697ed6c69},
+    {0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1},
+    {0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2},
+    {0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde},
+    {0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b},
+    {0xad4ab7112eb3929d, 0x86c16c98d2c953c6},
+    {0xd89d64d57a607744, 0xe871c7bf077ba8b7},
+    {0x87625f056c7c4a8b, 0x11471cd764ad4972},
+    {0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf},
+    {0xd389b47879823479, 0x4aff1d108d4ec2c3},
+    {0x843610cb4bf160cb, 0xcedf722a585139ba},
+    {0xa54394fe1eedb8fe, 0xc2974eb4ee658828},
+    {0xce947a3da6a9273e, 0x733d226229feea32},
+    {0x811ccc668829b887, 0x0806357d5a3f525f},
+    {0xa163ff802a3426a8, 0xca07c2dcb0cf26f7},
+    {0xc9bcff6034c13052, 0xfc89b393dd02f0b5},
+    {0xfc2c3f3841f17c67, 0xbbac2078d443ace2},
+    {0x9d9ba7832936edc0, 0xd54b944b84aa4c0d},
+    {0xc5029163f384a931, 0x0a9e795e65d4df11},
+    {0xf64335bcf065d37d, 0x4d4617b5ff4a16d5},
+    {0x99ea0196163fa42e, 0x504bced1bf8e4e45},
+    {0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6},
+    {0xf07da27a82c37088, 0x5d767327bb4e5a4c},
+    {0x964e858c91ba2655, 0x3a6a07f8d510f86f},
+    {0xbbe226efb628afea, 0x890489f70a55368b},
+    {0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e},
+    {0x92c8ae6b464fc96f, 0x3b0b8bc90012929d},
+    {0xb77ada0617e3bbcb, 0x09ce6ebb40173744},
+    {0xe55990879ddcaabd, 0xcc420a6a101d0515},
+    {0x8f57fa54c2a9eab6, 0x9fa946824a12232d},
+    {0xb32df8e9f3546564, 0x47939822dc96abf9},
+    {0xdff9772470297ebd, 0x59787e2b93bc56f7},
+    {0x8bfbea76c619ef36, 0x57eb4edb3c55b65a},
+    {0xaefae51477a06b03, 0xede622920b6b23f1},
+    {0xdab99e59958885c4, 0xe95fab368e45eced},
+    {0x88b402f7fd75539b, 0x11dbcb0218ebb414},
+    {0xaae103b5fcd2a881, 0xd652bdc29f26a119},
+    {0xd59944a37c0752a2, 0x4be76d3346f0495f},
+    {0x857fcae62d8493a5, 0x6f70a4400c562ddb},
+    {0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952},
+    {0xd097ad07a71f26b2, 0x7e2000a41346a7a7},
+    {0x825ecc24c873782f, 0x8ed400668c0c28c8},
+    {0xa2f67f2dfa90563b, 0x728900802f0f32fa},
+    {0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9},
+    {0xfea126b7d78186bc, 0xe2f610c84987bfa8},
+    {0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9},
+    {0xc6ede63fa05d3143, 0x91503d1c79720dbb},
+    {0xf8a95fcf88747d94, 0x75a44c6397ce912a},
+    {0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba},
+    {0xc24452da229b021b, 0xfbe85badce996168},
+    {0xf2d56790ab41c2a2, 0xfae27299423fb9c3},
+    {0x97c560ba6b0919a5, 0xdccd879fc967d41a},
+    {0xbdb6b8e905cb600f, 0x5400e987bbc1c920},
+    {0xed246723473e3813, 0x290123e9aab23b68},
+    {0x9436c0760c86e30b, 0xf9a0b6720aaf6521},
+    {0xb94470938fa89bce, 0xf808e40e8d5b3e69},
+    {0xe7958cb87392c2c2, 0xb60b1d1230b20e04},
+    {0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2},
+    {0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3},
+    {0xe2280b6c20dd5232, 0x25c6da63c38de1b0},
+    {0x8d590723948a535f, 0x579c487e5a38ad0e},
+    {0xb0af48ec79ace837, 0x2d835a9df0c6d851},
+    {0xdcdb1b2798182244, 0xf8e431456cf88e65},
+    {0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff},
+    {0xac8b2d36eed2dac5, 0xe272467e3d222f3f},
+    {0xd7adf884aa879177, 0x5b0ed81dcc6abb0f},
+    {0x86ccbb52ea94baea, 0x98e947129fc2b4e9},
+    {0xa87fea27a539e9a5, 0x3f2398d747b36224},
+    {0xd29fe4b18e88640e, 0x8eec7f0d19a03aad},
+    {0x83a3eeeef9153e89, 0x1953cf68300424ac},
+    {0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7},
+    {0xcdb02555653131b6, 0x3792f412cb06794d},
+    {0x808e17555f3ebf11, 0xe2bbd88bbee40bd0},
+    {0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4},
+    {0xc8de047564d20a8b, 0xf245825a5a445275},
+    {0xfb158592be068d2e, 0xeed6e2f0f0d56712},
+    {0x9ced737bb6c4183d, 0x55464dd69685606b},
+    {0xc428d05aa4751e4c, 0xaa97e14c3c26b886},
+    {0xf53304714d9265df, 0xd53dd99f4b3066a8},
+    {0x993fe2c6d07b7fab, 0xe546a8038efe4029},
+    {0xbf8fdb78849a5f96, 0xde98520472bdd033},
+    {0xef73d256a5c0f77c, 0x963e66858f6d4440},
+    {0x95a8637627989aad, 0xdde7001379a44aa8},
+    {0xbb127c53b17ec159, 0x5560c018580d5d52},
+    {0xe9d71b689dde71af, 0xaab8f01e6e10b4a6},
+    {0x9226712162ab070d, 0xcab3961304ca70e8},
+    {0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22},
+    {0xe45c10c42a2b3b05, 0x8cb89a7db77c506a},
+    {0x8eb98a7a9a5b04e3, 0x77f3608e92adb242},
+    {0xb267ed1940f1c61c, 0x55f038b237591ed3},
+    {0xdf01e85f912e37a3, 0x6b6c46dec52f6688},
+    {0x8b61313bbabce2c6, 0x2323ac4b3b3da015},
+    {0xae397d8aa96c1b77, 0xabec975e0a0d081a},
+    {0xd9c7dced53c72255, 0x96e7bd358c904a21},
+    {0x881cea14545c7575, 0x7e50d64177da2e54},
+    {0xaa242499697392d2, 0xdde50bd1d5d0b9e9},
+    {0xd4ad2dbfc3d07787, 0x955e4ec64b44e864},
+    {0x84ec3c97da624ab4, 0xbd5af13bef0b113e},
+    {0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e},
+    {0xcfb11ead453994ba, 0x67de18eda5814af2},
+    {0x81ceb32c4b43fcf4, 0x80eacf948770ced7},
+    {0xa2425ff75e14fc31, 0xa1258379a94d028d},
+    {0xcad2f7f5359a3b3e, 0x096ee45813a04330},
+    {0xfd87b5f28300ca0d, 0x8bca9d6e188853fc},
+    {0x9e74d1b791e07e48, 0x775ea264cf55347e},
+    {0xc612062576589dda, 0x95364afe032a819e},
+    {0xf79687aed3eec551, 0x3a83ddbd83f52205},
+    {0x9abe14cd44753b52, 0xc4926a9672793543},
+    {0xc16d9a0095928a27, 0x75b7053c0f178294},
+    {0xf1c90080baf72cb1, 0x5324c68b12dd6339},
+    {0x971da05074da7bee, 0xd3f6fc16ebca5e04},
+    {0xbce5086492111aea, 0x88f4bb1ca6bcf585},
+    {0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6},
+    {0x9392ee8e921d5d07, 0x3aff322e62439fd0},
+    {0xb877aa3236a4b449, 0x09befeb9fad487c3},
+    {0xe69594bec44de15b, 0x4c2ebe687989a9b4},
+    {0x901d7cf73ab0acd9, 0x0f9d37014bf60a11},
+    {0xb424dc35095cd80f, 0x538484c19ef38c95},
+    {0xe12e13424bb40e13, 0x2865a5f206b06fba},
+    {0x8cbccc096f5088cb, 0xf93f87b7442e45d4},
+    {0xafebff0bcb24aafe, 0xf78f69a51539d749},
+    {0xdbe6fecebdedd5be, 0xb573440e5a884d1c},
+    {0x89705f4136b4a597, 0x31680a88f8953031},
+    {0xabcc77118461cefc, 0xfdc20d2b36ba7c3e},
+    {0xd6bf94d5e57a42bc, 0x3d32907604691b4d},
+    {0x8637bd05af6c69b5, 0xa63f9a49c2c1b110},
+    {0xa7c5ac471b478423, 0x0fcf80dc33721d54},
+    {0xd1b71758e219652b, 0xd3c36113404ea4a9},
+    {0x83126e978d4fdf3b, 0x645a1cac083126ea},
+    {0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4},
+    {0xcccccccccccccccc, 0xcccccccccccccccd},
+    {0x8000000000000000, 0x0000000000000000},
+    {0xa000000000000000, 0x0000000000000000},
+    {0xc800000000000000, 0x0000000000000000},
+    {0xfa00000000000000, 0x0000000000000000},
+    {0x9c40000000000000, 0x0000000000000000},
+    {0xc350000000000000, 0x0000000000000000},
+    {0xf424000000000000, 0x0000000000000000},
+    {0x9896800000000000, 0x0000000000000000},
+    {0xbebc200000000000, 0x0000000000000000},
+    {0xee6b280000000000, 0x0000000000000000},
+    {0x9502f90000000000, 0x0000000000000000},
+    {0xba43b74000000000, 0x0000000000000000},
+    {0xe8d4a51000000000, 0x0000000000000000},
+    {0x9184e72a00000000, 0x0000000000000000},
+    {0xb5e620f480000000, 0x0000000000000000},
+    {0xe35fa931a0000000, 0x0000000000000000},
+    {0x8e1bc9bf04000000, 0x0000000000000000},
+    {0xb1a2bc2ec5000000, 0x0000000000000000},
+    {0xde0b6b3a76400000, 0x0000000000000000},
+    {0x8ac7230489e80000, 0x0000000000000000},
+    {0xad78ebc5ac620000, 0x0000000000000000},
+    {0xd8d726b7177a8000, 0x0000000000000000},
+    {0x878678326eac9000, 0x0000000000000000},
+    {0xa968163f0a57b400, 0x0000000000000000},
+    {0xd3c21bcecceda100, 0x0000000000000000},
+    {0x84595161401484a0, 0x0000000000000000},
+    {0xa56fa5b99019a5c8, 0x0000000000000000},
+    {0xcecb8f27f4200f3a, 0x0000000000000000},
+    {0x813f3978f8940984, 0x4000000000000000},
+    {0xa18f07d736b90be5, 0x5000000000000000},
+    {0xc9f2c9cd04674ede, 0xa400000000000000},
+    {0xfc6f7c4045812296, 0x4d00000000000000},
+    {0x9dc5ada82b70b59d, 0xf020000000000000},
+    {0xc5371912364ce305, 0x6c28000000000000},
+    {0xf684df56c3e01bc6, 0xc732000000000000},
+    {0x9a130b963a6c115c, 0x3c7f400000000000},
+    {0xc097ce7bc90715b3, 0x4b9f100000000000},
+    {0xf0bdc21abb48db20, 0x1e86d40000000000},
+    {0x96769950b50d88f4, 0x1314448000000000},
+    {0xbc143fa4e250eb31, 0x17d955a000000000},
+    {0xeb194f8e1ae525fd, 0x5dcfab0800000000},
+    {0x92efd1b8d0cf37be, 0x5aa1cae500000000},
+    {0xb7abc627050305ad, 0xf14a3d9e40000000},
+    {0xe596b7b0c643c719, 0x6d9ccd05d0000000},
+    {0x8f7e32ce7bea5c6f, 0xe4820023a2000000},
+    {0xb35dbf821ae4f38b, 0xdda2802c8a800000},
+    {0xe0352f62a19e306e, 0xd50b2037ad200000},
+    {0x8c213d9da502de45, 0x4526f422cc340000},
+    {0xaf298d050e4395d6, 0x9670b12b7f410000},
+    {0xdaf3f04651d47b4c, 0x3c0cdd765f114000},
+    {0x88d8762bf324cd0f, 0xa5880a69fb6ac800},
+    {0xab0e93b6efee0053, 0x8eea0d047a457a00},
+    {0xd5d238a4abe98068, 0x72a4904598d6d880},
+    {0x85a36366eb71f041, 0x47a6da2b7f864750},
+    {0xa70c3c40a64e6c51, 0x999090b65f67d924},
+    {0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d},
+    {0x82818f1281ed449f, 0xbff8f10e7a8921a4},
+    {0xa321f2d7226895c7, 0xaff72d52192b6a0d},
+    {0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490},
+    {0xfee50b7025c36a08, 0x02f236d04753d5b4},
+    {0x9f4f2726179a2245, 0x01d762422c946590},
+    {0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5},
+    {0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2},
+    {0x9b934c3b330c8577, 0x63cc55f49f88eb2f},
+    {0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb},
+    {0xf316271c7fc3908a, 0x8bef464e3945ef7a},
+    {0x97edd871cfda3a56, 0x97758bf0e3cbb5ac},
+    {0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317},
+    {0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd},
+    {0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a},
+    {0xb975d6b6ee39e436, 0xb3e2fd538e122b44},
+    {0xe7d34c64a9c85d44, 0x60dbbca87196b616},
+    {0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd},
+    {0xb51d13aea4a488dd, 0x6babab6398bdbe41},
+    {0xe264589a4dcdab14, 0xc696963c7eed2dd1},
+    {0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2},
+    {0xb0de65388cc8ada8, 0x3b25a55f43294bcb},
+    {0xdd15fe86affad912, 0x49ef0eb713f39ebe},
+    {0x8a2dbf142dfcc7ab, 0x6e3569326c784337},
+    {0xacb92ed9397bf996, 0x49c2c37f07965404},
+    {0xd7e77a8f87daf7fb, 0xdc33745ec97be906},
+    {0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3},
+    {0xa8acd7c0222311bc, 0xc40832ea0d68ce0c},
+    {0xd2d80db02aabd62b, 0xf50a3fa490c30190},
+    {0x83c7088e1aab65db, 0x792667c6da79e0fa},
+    {0xa4b8cab1a1563f52, 0x577001b891185938},
+    {0xcde6fd5e09abcf26, 0xed4c0226b55e6f86},
+    {0x80b05e5ac60b6178, 0x544f8158315b05b4},
+    {0xa0dc75f1778e39d6, 0x696361ae3db1c721},
+    {0xc913936dd571c84c, 0x03bc3a19cd1e38e9},
+    {0xfb5878494ace3a5f, 0x04ab48a04065c723},
+    {0x9d174b2dcec0e47b, 0x62eb0d64283f9c76},
+    {0xc45d1df942711d9a, 0x3ba5d0bd324f8394},
+    {0xf5746577930d6500, 0xca8f44ec7ee36479},
+    {0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb},
+    {0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e},
+    {0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e},
+    {0x95d04aee3b80ece5, 0xbba1f1d158724a12},
+    {0xbb445da9ca61281f, 0x2a8a6e45ae8edc97},
+    {0xea1575143cf97226, 0xf52d09d71a3293bd},
+    {0x924d692ca61be758, 0x593c2626705f9c56},
+    {0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c},
+    {0xe498f455c38b997a, 0x0b6dfb9c0f956447},
+    {0x8edf98b59a373fec, 0x4724bd4189bd5eac},
+    {0xb2977ee300c50fe7, 0x58edec91ec2cb657},
+    {0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed},
+    {0x8b865b215899f46c, 0xbd79e0d20082ee74},
+    {0xae67f1e9aec07187, 0xecd8590680a3aa11},
+    {0xda01ee641a708de9, 0xe80e6f4820cc9495},
+    {0x884134fe908658b2, 0x3109058d147fdcdd},
+    {0xaa51823e34a7eede, 0xbd4b46f0599fd415},
+    {0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a},
+    {0x850fadc09923329e, 0x03e2cf6bc604ddb0},
+    {0xa6539930bf6bff45, 0x84db8346b786151c},
+    {0xcfe87f7cef46ff16, 0xe612641865679a63},
+    {0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e},
+    {0xa26da3999aef7749, 0xe3be5e330f38f09d},
+    {0xcb090c8001ab551c, 0x5cadf5bfd3072cc5},
+    {0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6},
+    {0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa},
+    {0xc646d63501a1511d, 0xb281e1fd541501b8},
+    {0xf7d88bc24209a565, 0x1f225a7ca91a4226},
+    {0x9ae757596946075f, 0x3375788de9b06958},
+    {0xc1a12d2fc3978937, 0x0052d6b1641c83ae},
+    {0xf209787bb47d6b84, 0xc0678c5dbd23a49a},
+    {0x9745eb4d50ce6332, 0xf840b7ba963646e0},
+    {0xbd176620a501fbff, 0xb650e5a93bc3d898},
+    {0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe},
+    {0x93ba47c980e98cdf, 0xc66f336c36b10137},
+    {0xb8a8d9bbe123f017, 0xb80b0047445d4184},
+    {0xe6d3102ad96cec1d, 0xa60dc059157491e5},
+    {0x9043ea1ac7e41392, 0x87c89837ad68db2f},
+    {0xb454e4a179dd1877, 0x29babe4598c311fb},
+    {0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a},
+    {0x8ce2529e2734bb1d, 0x1899e4a65f58660c},
+    {0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f},
+    {0xdc21a1171d42645d, 0x76707543f4fa1f73},
+    {0x899504ae72497eba, 0x6a06494a791c53a8},
+    {0xabfa45da0edbde69, 0x0487db9d17636892},
+    {0xd6f8d7509292d603, 0x45a9d2845d3c42b6},
+    {0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2},
+    {0xa7f26836f282b732, 0x8e6cac7768d7141e},
+    {0xd1ef0244af2364ff, 0x3207d795430cd926},
+    {0x8335616aed761f1f, 0x7f44e6bd49e807b8},
+    {0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6},
+    {0xcd036837130890a1, 0x36dba887c37a8c0f},
+    {0x802221226be55a64, 0xc2494954da2c9789},
+    {0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c},
+    {0xc83553c5c8965d3d, 0x6f92829494e5acc7},
+    {0xfa42a8b73abbf48c, 0xcb772339ba1f17f9},
+    {0x9c69a97284b578d7, 0xff2a760414536efb},
+    {0xc38413cf25e2d70d, 0xfef5138519684aba},
+    {0xf46518c2ef5b8cd1, 0x7eb258665fc25d69},
+    {0x98bf2f79d5993802, 0xef2f773ffbd97a61},
+    {0xbeeefb584aff8603, 0xaafb550ffacfd8fa},
+    {0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38},
+    {0x952ab45cfa97a0b2, 0xdd945a747bf26183},
+    {0xba756174393d88df, 0x94f971119aeef9e4},
+    {0xe912b9d1478ceb17, 0x7a37cd5601aab85d},
+    {0x91abb422ccb812ee, 0xac62e055c10ab33a},
+    {0xb616a12b7fe617aa, 0x577b986b314d6009},
+    {0xe39c49765fdf9d94, 0xed5a7e85fda0b80b},
+    {0x8e41ade9fbebc27d, 0x14588f13be847307},
+    {0xb1d219647ae6b31c, 0x596eb2d8ae258fc8},
+    {0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb},
+    {0x8aec23d680043bee, 0x25de7bb9480d5854},
+    {0xada72ccc20054ae9, 0xaf561aa79a10ae6a},
+    {0xd910f7ff28069da4, 0x1b2ba1518094da04},
+    {0x87aa9aff79042286, 0x90fb44d2f05d0842},
+    {0xa99541bf57452b28, 0x353a1607ac744a53},
+    {0xd3fa922f2d1675f2, 0x42889b8997915ce8},
+    {0x847c9b5d7c2e09b7, 0x69956135febada11},
+    {0xa59bc234db398c25, 0x43fab9837e699095},
+    {0xcf02b2c21207ef2e, 0x94f967e45e03f4bb},
+    {0x8161afb94b44f57d, 0x1d1be0eebac278f5},
+    {0xa1ba1ba79e1632dc, 0x6462d92a69731732},
+    {0xca28a291859bbf93, 0x7d7b8f7503cfdcfe},
+    {0xfcb2cb35e702af78, 0x5cda735244c3d43e},
+    {0x9defbf01b061adab, 0x3a0888136afa64a7},
+    {0xc56baec21c7a1916, 0x088aaa1845b8fdd0},
+    {0xf6c69a72a3989f5b, 0x8aad549e57273d45},
+    {0x9a3c2087a63f6399, 0x36ac54e2f678864b},
+    {0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd},
+    {0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5},
+    {0x969eb7c47859e743, 0x9f644ae5a4b1b325},
+    {0xbc4665b596706114, 0x873d5d9f0dde1fee},
+    {0xeb57ff22fc0c7959, 0xa90cb506d155a7ea},
+    {0x9316ff75dd87cbd8, 0x09a7f12442d588f2},
+    {0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f},
+    {0xe5d3ef282a242e81, 0x8f1668c8a86da5fa},
+    {0x8fa475791a569d10, 0xf96e017d694487bc},
+    {0xb38d92d760ec4455, 0x37c981dcc395a9ac},
+    {0xe070f78d3927556a, 0x85bbe253f47b1417},
+    {0x8c469ab843b89562, 0x93956d7478ccec8e},
+    {0xaf58416654a6babb, 0x387ac8d1970027b2},
+    {0xdb2e51bfe9d0696a, 0x06997b05fcc0319e},
+    {0x88fcf317f22241e2, 0x441fece3bdf81f03},
+    {0xab3c2fddeeaad25a, 0xd527e81cad7626c3},
+    {0xd60b3bd56a5586f1, 0x8a71e223d8d3b074},
+    {0x85c7056562757456, 0xf6872d5667844e49},
+    {0xa738c6bebb12d16c, 0xb428f8ac016561db},
+    {0xd106f86e69d785c7, 0xe13336d701beba52},
+    {0x82a45b450226b39c, 0xecc0024661173473},
+    {0xa34d721642b06084, 0x27f002d7f95d0190},
+    {0xcc20ce9bd35c78a5, 0x31ec038df7b441f4},
+    {0xff290242c83396ce, 0x7e67047175a15271},
+    {0x9f79a169bd203e41, 0x0f0062c6e984d386},
+    {0xc75809c42c684dd1, 0x52c07b78a3e60868},
+    {0xf92e0c3537826145, 0xa7709a56ccdf8a82},
+    {0x9bbcc7a142b17ccb, 0x88a66076400bb691},
+    {0xc2abf989935ddbfe, 0x6acff893d00ea435},
+    {0xf356f7ebf83552fe, 0x0583f6b8c4124d43},
+    {0x98165af37b2153de, 0xc3727a337a8b704a},
+    {0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c},
+    {0xeda2ee1c7064130c, 0x1162def06f79df73},
+    {0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8},
+    {0xb9a74a0637ce2ee1, 0x6d953e2bd7173692},
+    {0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437},
+    {0x910ab1d4db9914a0, 0x1d9c9892400a22a2},
+    {0xb54d5e4a127f59c8, 0x2503beb6d00cab4b},
+    {0xe2a0b5dc971f303a, 0x2e44ae64840fd61d},
+    {0x8da471a9de737e24, 0x5ceaecfed289e5d2},
+    {0xb10d8e1456105dad, 0x7425a83e872c5f47},
+    {0xdd50f1996b947518, 0xd12f124e28f77719},
+    {0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f},
+    {0xace73cbfdc0bfb7b, 0x636cc64d1001550b},
+    {0xd8210befd30efa5a, 0x3c47f7e05401aa4e},
+    {0x8714a775e3e95c78, 0x65acfaec34810a71},
+    {0xa8d9d1535ce3b396, 0x7f1839a741a14d0d},
+    {0xd31045a8341ca07c, 0x1ede48111209a050},
+    {0x83ea2b892091e44d, 0x934aed0aab460432},
+    {0xa4e4b66b68b65d60, 0xf81da84d5617853f},
+    {0xce1de40642e3f4b9, 0x36251260ab9d668e},
+    {0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019},
+    {0xa1075a24e4421730, 0xb24cf65b8612f81f},
+    {0xc94930ae1d529cfc, 0xdee033f26797b627},
+    {0xfb9b7cd9a4a7443c, 0x169840ef017da3b1},
+    {0x9d412e0806e88aa5, 0x8e1f289560ee864e},
+    {0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2},
+    {0xf5b5d7ec8acb58a2, 0xae10af696774b1db},
+    {0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29},
+    {0xbff610b0cc6edd3f, 0x17fd090a58d32af3},
+    {0xeff394dcff8a948e, 0xddfc4b4cef07f5b0},
+    {0x95f83d0a1fb69cd9, 0x4abdaf101564f98e},
+    {0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1},
+    {0xea53df5fd18d5513, 0x84c86189216dc5ed},
+    {0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4},
+    {0xb7118682dbb66a77, 0x3fbc8c33221dc2a1},
+    {0xe4d5e82392a40515, 0x0fabaf3feaa5334a},
+    {0x8f05b1163ba6832d, 0x29cb4d87f2a7400e},
+    {0xb2c71d5bca9023f8, 0x743e20e9ef511012},
+    {0xdf78e4b2bd342cf6, 0x914da9246b255416},
+    {0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e},
+    {0xae9672aba3d0c320, 0xa184ac2473b529b1},
+    {0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e},
+    {0x8865899617fb1871, 0x7e2fa67c7a658892},
+    {0xaa7eebfb9df9de8d, 0xddbb901b98feeab7},
+    {0xd51ea6fa85785631, 0x552a74227f3ea565},
+    {0x8533285c936b35de, 0xd53a88958f87275f},
+    {0xa67ff273b8460356, 0x8a892abaf368f137},
+    {0xd01fef10a657842c, 0x2d2b7569b0432d85},
+    {0x8213f56a67f6b29b, 0x9c3b29620e29fc73},
+    {0xa298f2c501f45f42, 0x8349f3ba91b47b8f},
+    {0xcb3f2f7642717713, 0x241c70a936219a73},
+    {0xfe0efb53d30dd4d7, 0xed238cd383aa0110},
+    {0x9ec95d1463e8a506, 0xf4363804324a40aa},
+    {0xc67bb4597ce2ce48, 0xb143c6053edcd0d5},
+    {0xf81aa16fdc1b81da, 0xdd94b7868e94050a},
+    {0x9b10a4e5e9913128, 0xca7cf2b4191c8326},
+    {0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0},
+    {0xf24a01a73cf2dccf, 0xbc633b39673c8cec},
+    {0x976e41088617ca01, 0xd5be0503e085d813},
+    {0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18},
+    {0xec9c459d51852ba2, 0xddf8e7d60ed1219e},
+    {0x93e1ab8252f33b45, 0xcabb90e5c942b503},
+    {0xb8da1662e7b00a17, 0x3d6a751f3b936243},
+    {0xe7109bfba19c0c9d, 0x0cc512670a783ad4},
+    {0x906a617d450187e2, 0x27fb2b80668b24c5},
+    {0xb484f9dc9641e9da, 0xb1f9f660802dedf6},
+    {0xe1a63853bbd26451, 0x5e7873f8a0396973},
+    {0x8d07e33455637eb2, 0xdb0b487b6423e1e8},
+    {0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62},
+    {0xdc5c5301c56b75f7, 0x7641a140cc7810fb},
+    {0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d},
+    {0xac2820d9623bf429, 0x546345fa9fbdcd44},
+    {0xd732290fbacaf133, 0xa97c177947ad4095},
+    {0x867f59a9d4bed6c0, 0x49ed8eabcccc485d},
+    {0xa81f301449ee8c70, 0x5c68f256bfff5a74},
+    {0xd226fc195c6a2f8c, 0x73832eec6fff3111},
+    {0x83585d8fd9c25db7, 0xc831fd53c5ff7eab},
+    {0xa42e74f3d032f525, 0xba3e7ca8b77f5e55},
+    {0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb},
+    {0x80444b5e7aa7cf85, 0x7980d163cf5b81b3},
+    {0xa0555e361951c366, 0xd7e105bcc332621f},
+    {0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7},
+    {0xfa856334878fc150, 0xb14f98f6f0feb951},
+    {0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3},
+    {0xc3b8358109e84f07, 0x0a862f80ec4700c8},
+    {0xf4a642e14c6262c8, 0xcd27bb612758c0fa},
+    {0x98e7e9cccfbd7dbd, 0x8038d51cb897789c},
+    {0xbf21e44003acdd2c, 0xe0470a63e6bd56c3},
+    {0xeeea5d5004981478, 0x1858ccfce06cac74},
+    {0x95527a5202df0ccb, 0x0f37801e0c43ebc8},
+    {0xbaa718e68396cffd, 0xd30560258f54e6ba},
+    {0xe950df20247c83fd, 0x47c6b82ef32a2069},
+    {0x91d28b7416cdd27e, 0x4cdc331d57fa5441},
+    {0xb6472e511c81471d, 0xe0133fe4adf8e952},
+    {0xe3d8f9e563a198e5, 0x58180fddd97723a6},
+    {0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648},
+    {0xb201833b35d63f73, 0x2cd2cc6551e513da},
+    {0xde81e40a034bcf4f, 0xf8077f7ea65e58d1},
+    {0x8b112e86420f6191, 0xfb04afaf27faf782},
+    {0xadd57a27d29339f6, 0x79c5db9af1f9b563},
+    {0xd94ad8b1c7380874, 0x18375281ae7822bc},
+    {0x87cec76f1c830548, 0x8f2293910d0b15b5},
+    {0xa9c2794ae3a3c69a, 0xb2eb3875504ddb22},
+    {0xd433179d9c8cb841, 0x5fa60692a46151eb},
+    {0x849feec281d7f328, 0xdbc7c41ba6bcd333},
+    {0xa5c7ea73224deff3, 0x12b9b522906c0800},
+    {0xcf39e50feae16bef, 0xd768226b34870a00},
+    {0x81842f29f2cce375, 0xe6a1158300d46640},
+    {0xa1e53af46f801c53, 0x60495ae3c1097fd0},
+    {0xca5e89b18b602368, 0x385bb19cb14bdfc4},
+    {0xfcf62c1dee382c42, 0x46729e03dd9ed7b5},
+    {0x9e19db92b4e31ba9, 0x6c07a2c26a8346d1},
+};
+
+// Full 64x64-bit multiplication.
+static void multiply_128(uint64_t a, uint64_t b, uint64_t *high, uint64_t *low)
+{
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 product = (uint128)a * b;
+    *high = (uint64_t)(product >> 64);
+    *low = (uint64_t)product;
+#else
+    uint64_t a_low = (uint32_t)a, a_high = a >> 32;
+    uint64_t b_low = (uint32_t)b, b_high = b >> 32;
+    uint64_t low_low = a_low * b_low, low_high = a_low * b_high;
+    uint64_t high_low = a_high * b_low, high_high = a_high * b_high;
+    uint64_t middle = (low_low >> 32) + (uint32_t)low_high + high_low;
+    *high = high_high + (middle >> 32) + (low_high >> 32);
+    *low = (middle << 32) | (uint32_t)low_low;
+#endif
+}
+
+// Returns the number of leading zero bits of a non-zero value.
+static inline int leading_zeros(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(value);
+#else
+    int count = 0;
+    while (!(value & (UINT64_C(1) << 63)))
+        value <<= 1, count++;
+    return count;
+#endif
+}
+
+// Computes the bits of the double nearest to mantissa * 10^exponent with the
+// Eisel-Lemire algorithm. Returns true when the result isn't a normal finite
+// double or can't be decided this way, leaving the conversion to strtod.
+static bool eisel_lemire(uint64_t mantissa, int64_t exponent, uint64_t *out)
+{
+    if (mantissa == 0 || exponent < POWER_OF_FIVE_MIN || exponent > POWER_OF_FIVE_MAX)
+        return true;
+
+    int shift = leading_zeros(mantissa);
+    mantissa <<= shift;
+
+    const uint64_t *power = POWERS_OF_FIVE[exponent - POWER_OF_FIVE_MIN];
+    uint64_t high, low;
+    multiply_128(mantissa, power[0], &high, &low);
+
+    // Refine with the lower half of the power when the truncation could matter.
+    if ((high & 0x1FF) == 0x1FF)
+    {
+        uint64_t second_high, second_low;
+        multiply_128(mantissa, power[1], &second_high, &second_low);
+        low += second_high;
+        if (second_high > low)
+            high++;
+        if (low == UINT64_MAX && (exponent < -27 || exponent > 55))
+            return true;
+    }
+
+    // floor(exponent * log2(10)), with a flooring shift for negative exponents.
+    int64_t scaled_exponent = 217706 * exponent;
+    int64_t binary_exponent = scaled_exponent >= 0 ? scaled_exponent >> 16 : -((-scaled_exponent + 0xFFFF) >> 16);
+
+    int upper_bit = (int)(high >> 63);
+    uint64_t bits = high >> (upper_bit + 9);
+    int64_t biased_exponent = binary_exponent + 63 + upper_bit - shift + 1023;
+    if (biased_exponent <= 0)
+        return true;
+
+    // Exact halfway cases round to even.
+    if (low <= 1 && exponent >= -4 && exponent <= 23 && (bits & 3) == 1
+        && (bits << (upper_bit + 9)) == high)
+        bits &= ~(uint64_t)1;
+
+    bits += bits & 1;
+    bits >>= 1;
+    if (bits >= (UINT64_C(2) << 52))
+    {
+        bits = UINT64_C(1) << 52;
+        biased_exponent++;
+    }
+    if (biased_exponent >= 0x7FF)
+        return true;
+
+    *out = (bits & ~(UINT64_C(1) << 52)) | (uint64_t)biased_exponent << 52;
+    return false;
+}
+
+// Gets the exact magnitude of a number without fraction or exponent, which can have
+// one more digit than the mantissa holds. Returns true if it doesn't fit in 64 bits.
+static bool decimal_integer_magnitude(const decimal_number *decimal, const char *end, uint64_t *out)
+{
+    if (decimal->exponent == 0)
+    {
+        *out = decimal->mantissa;
+        return false;
+    }
+    if (decimal->exponent != 1)
+        return true;
+
+    // The only dropped digit is the last character of the number.
+    uint64_t last_digit = end[-1] - '0';
+    if (decimal->mantissa > (UINT64_MAX - last_digit) / 10)
+        return true;
+    *out = decimal->mantissa * 10 + last_digit;
+    return false;
+}
+
+// Converts a decimal number to the nearest double without strtod when possible.
+// Returns true when the slow path is needed.
+static bool decimal_to_double(const decimal_number *decimal, double *out)
+{
+    double value;
+    if (decimal->mantissa == 0 && !decimal->truncated)
+        value = 0.0;
+#if FLT_EVAL_METHOD == 0
+    // Both operands are exact doubles, so a single operation rounds correctly.
+    else if (!decimal->truncated && decimal->mantissa <= (UINT64_C(1) << 53)
+        && decimal->exponent >= -22 && decimal->exponent <= 22)
+    {
+        static const double powers_of_ten[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        value = (double)decimal->mantissa;
+        if (decimal->exponent < 0)
+            value /= powers_of_ten[-decimal->exponent];
+        else
+            value *= powers_of_ten[decimal->exponent];
+    }
+#endif
+    else
+    {
+        uint64_t bits;
+        if (eisel_lemire(decimal->mantissa, decimal->exponent, &bits))
+            return true;
+
+        // Dropped digits put the number between mantissa and mantissa + 1.
+        if (decimal->truncated)
+        {
+            uint64_t upper_bits;
+            if (eisel_lemire(decimal->mantissa + 1, decimal->exponent, &upper_bits) || upper_bits != bits)
+                return true;
+        }
+        memcpy(&value, &bits, sizeof(value));
+    }
+
+    *out = decimal->negative ? -value : value;
+    return false;
+}
+
+#ifdef JSON_HAS_USELOCALE
+// Returns the "C" numeric locale, created once by the first conversion needing it and
+// kept for the whole process, or (locale_t)0 if it can't be created.
+static locale_t numeric_c_locale(void)
+{
+    static _Atomic(locale_t) shared_locale;
+    locale_t locale = atomic_load_explicit(&shared_locale, memory_order_acquire);
+    if (locale != (locale_t)0)
+        return locale;
+
+    locale_t created = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    if (created == (locale_t)0)
+        return created;
+    if (atomic_compare_exchange_strong_explicit(&shared_locale, &locale, created, memory_order_acq_rel, memory_order_acquire))
+        return created;
+
+    // Another thread created it first.
+    freelocale(created);
+    return locale;
+}
+#endif
+
+// Converts a valid JSON number with strtod, under the "C" numeric locale of the calling
+// thread where per-thread locales are available. Elsewhere, the decimal point is replaced
+// with the one of the current locale, which mustn't change while numbers are parsed since
+// localeconv isn't thread-safe. Sets overflow if the number is out of range.
+static bool convert_number_slowly(const char *data, size_t length, double *out, bool *overflow)
+{
+#ifdef JSON_HAS_USELOCALE
+    locale_t c_locale = numeric_c_locale();
+    const char *decimal_point = c_locale != (locale_t)0 ? "." : localeconv()->decimal_point;
+#else
+    const char *decimal_point = localeconv()->decimal_point;
+#endif
+    size_t decimal_point_length = strlen(decimal_point);
+
+    char local_buffer[64];
+    size_t size = length + decimal_point_length + 1;
+    char *buffer = size <= sizeof(local_buffer) ? local_buffer : malloc(size);
+    if (!buffer) return true;
+
+    size_t position = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (data[i] == '.')
+        {
+            memcpy(buffer + position, decimal_point, decimal_point_length);
+            position += decimal_point_length;
+        }
+        else
+            buffer[position++] = data[i];
+    }
+    buffer[position] = '\0';
+
+#ifdef JSON_HAS_USELOCALE
+    locale_t previous_locale = c_locale != (locale_t)0 ? uselocale(c_locale) : (locale_t)0;
+#endif
+    errno = 0;
+    double value = strtod(buffer, NULL);
+    *overflow = errno == ERANGE && (value == HUGE_VAL || value == -HUGE_VAL);
+    *out = value;
+#ifdef JSON_HAS_USELOCALE
+    if (previous_locale != (locale_t)0)
+        uselocale(previous_locale);
+#endif
+
+    if (buffer != local_buffer)
+        free(buffer);
+    return false;
+}
+
+// Shifts right, rounding towards negative infinity for negative values too.
+static int64_t floor_shift(int64_t value, int shift)
+{
+    return value >= 0 ? value >> shift : -((-value + ((INT64_C(1) << shift) - 1)) >> shift);
+}
+
+// floor(e * log10(2)), floor(log10(3/4 * 2^e)) and floor(e * log2(10)), for the exponents of doubles.
+static int floor_log10_pow2(int e)
+{
+    return (int)floor_shift(e * INT64_C(661971961083), 41);
+}
+
+static int floor_log10_three_quarters_pow2(int e)
+{
+    return (int)floor_shift(e * INT64_C(661971961083) - INT64_C(274743187321), 41);
+}
+
+static int floor_log2_pow10(int e)
+{
+    return (int)floor_shift(e * INT64_C(913124641741), 38);
+}
+
+static const uint64_t LOW_63_BITS = (UINT64_C(1) << 63) - 1;
+
+// Gets g = floor(10^-k * 2^r) + 1 on 126 bits, r being such that 2^125 <= g < 2^126, from the
+// table of the powers of five, as its upper and lower 63 bits.
+static void power_of_ten_upper_bound(int k, uint64_t *g1, uint64_t *g0)
+{
+    const uint64_t *power = POWERS_OF_FIVE[-k - POWER_OF_FIVE_MIN];
+    uint64_t high = power[0], low = power[1];
+    if (-k >= -27 && -k <= -1 && low-- == 0)
+        high--;
+
+    // The table holds 128 bits, of which the upper 126 are kept.
+    uint64_t g_low = (low >> 2) | (high << 62);
+    uint64_t g_high = high >> 2;
+    if (++g_low == 0)
+        g_high++;
+    *g1 = (g_high << 1) | (g_low >> 63);
+    *g0 = g_low & LOW_63_BITS;
+}
+
+// Multiplies g by cp, keeping the upper 64 bits of the product rounded to odd.
+static uint64_t round_to_odd(uint64_t g1, uint64_t g0, uint64_t cp)
+{
+    uint64_t x1, y0, y1, unused;
+    multiply_128(g0, cp, &x1, &unused);
+    multiply_128(g1, cp, &y1, &y0);
+    uint64_t z = (y0 >> 1) + x1;
+    uint64_t vbp = y1 + (z >> 63);
+    return vbp | (((z & LOW_63_BITS) + LOW_63_BITS) >> 63);
+}
+
+// Finds the decimal f * 10^e with the fewest digits that rounds to the double c * 2^q,
+// the closest one when several do, with the Schubfach algorithm. The decimal exponent
+// is adjusted by dk, for subnormals whose significand was scaled by ten.
+static void shortest_decimal(int q, uint64_t c, int dk, uint64_t *f, int *e)
+{
+    uint64_t out = c & 1;
+    uint64_t cb = c << 2;
+    uint64_t cbr = cb + 2;
+    uint64_t cbl;
+    int k;
+    // The interval rounding to the double is narrower below powers of two.
+    if (c != UINT64_C(1) << 52 || q == -1074)
+    {
+        cbl = cb - 2;
+        k = floor_log10_pow2(q);
+    }
+    else
+    {
+        cbl = cb - 1;
+        k = floor_log10_three_quarters_pow2(q);
+    }
+    int h = q + floor_log2_pow10(-k) + 2;
+
+    uint64_t g1, g0;
+    power_of_ten_upper_bound(k, &g1, &g0);
+    uint64_t vb = round_to_odd(g1, g0, cb << h);
+    uint64_t vbl = round_to_odd(g1, g0, cbl << h);
+    uint64_t vbr = round_to_odd(g1, g0, cbr << h);
+
+    // A multiple of ten in the interval has one digit less.
+    uint64_t s = vb >> 2;
+    *e = k + dk;
+    uint64_t sp10 = s / 10 * 10;
+    uint64_t tp10 = sp10 + 10;
+    bool upin = vbl + out <= sp10 << 2;
+    bool wpin = (tp10 << 2) + out <= vbr;
+    if (upin != wpin)
+    {
+        *f = upin ? sp10 : tp10;
+        return;
+    }
+
+    // Otherwise one of the two decimals around the double is in the interval.
+    uint64_t t = s + 1;
+    bool uin = vbl + out <= s << 2;
+    bool win = (t << 2) + out <= vbr;
+    if (uin != win)
+    {
+        *f = uin ? s : t;
+        return;
+    }
+
+    // Both are, the closest one is taken, or the even one when they are as close.
+    int64_t cmp = (int64_t)(vb - ((s + t) << 1));
+    *f = cmp < 0 || (cmp == 0 && (s & 1) == 0) ? s : t;
+}
+
+// ----------
+// JSON Parsing
+// ----------
+
+const json_parse_options JSON_DEFAULT_PARSE_OPTIONS = {
+    .error_info = NULL,
+    .max_depth = DEFAULT_MAX_DEPTH,
+    .read_buffer_size = DEFAULT_READ_BUFFER_SIZE
+};
+
+// Values (and their keys inside objects) of the containers being parsed,
+// moved into their container once it is complete.
+typedef struct parse_stack {
+    size_t size;
+    size_t capacity;
+    json_value **values;
+    char **keys;
+} parse_stack;
+
+// The parser reads its input through a window of contiguous bytes. In-memory
+// inputs are a single window covering the whole buffer, while streamed inputs
+// refill the window through read_more once it is exhausted.
+typedef struct json_parser {
+    const json_parse_options *options;
+    json_error_info *error_info;
+
+    const char *window;
+    const char *cursor;
+    const char *end;
+    size_t (*read_more)(struct json_parser *parser);
+    size_t window_offset;
+
+    FILE *input_file;
+    char *read_buffer;
+    size_t read_buffer_size;
+    bool input_error;
+
+    json_document *document;
+    char *insitu_buffer;
+    string_builder scratch;
+    parse_stack stack;
+
+    uint32_t *structurals;
+    size_t structural_count, structural_capacity;
+    size_t next_structural;
+
+    lazy_source *lazy_source;
+    size_t defer_depth;
+
+    size_t line, line_start;
+    size_t depth;
+    json_error error;
+} json_parser;
+
+// Replaces the input window, keeping track of the absolute input offset.
+static void set_input_window(json_parser *parser, const char *data, size_t size)
+{
+    if (parser->window)
+        parser->window_offset += parser->end - parser->window;
+    parser->window = data;
+    parser->cursor = data;
+    parser->end = data + size;
+}
+
+// Returns the absolute offset of the cursor in the input.
+static size_t input_offset(const json_parser *parser)
+{
+    return parser->window_offset + (parser->cursor - parser->window);
+}
+
+// Checks that at least one byte is available, refilling the window if needed.
+static inline bool has_input(json_parser *parser)
+{
+    return parser->cursor != parser->end
+        || (parser->read_more && parser->read_more(parser) != 0);
+}
+
+// Returns the current character without consuming it, or EOF at the end of input.
+static inline int peek(json_parser *parser)
+{
+    return has_input(parser) ? (unsigned char)*parser->cursor : EOF;
+}
+
+// Recomputes the line of the cursor, which isn't tracked when building from the structural index,
+// nor across the containers skipped by lazy parses.
+static void locate_cursor(json_parser *parser)
+{
+    parser->line = 1;
+    parser->line_start = 0;
+
+    const char *line_end = parser->window;
+    while ((line_end = memchr(line_end, '\n', parser->cursor - line_end)))
+    {
+        parser->line++;
+        parser->line_start = ++line_end - parser->window;
+    }
+}
+
+// Reports a parsing error at the current location.
+static void report_parsing_error(json_parser *parser, json_error error_type, const char *error_fmt, ...)
+{
+    parser->error = error_type;
+
+    if (!parser->error_info) return;
+    if (parser->structurals || parser->defer_depth)
+        locate_cursor(parser);
+    parser->error_info->line = parser->line;
+    parser->error_info->column = input_offset(parser) - parser->line_start + 1;
+    parser->error_info->error = error_type;
+
+    va_list args, args_copy;
+    va_start(args, error_fmt);
+
+    va_copy(args_copy, args);
+    int size = vsnprintf(NULL, 0, error_fmt, args_copy);
+    va_end(args_copy);
+    if (size < 0)
+    {
+        va_end(args);
+        strcpy(parser->error_info->message, "invalid error message format");
+        return;
+    }
+
+    vsnprintf(parser->error_info->message, 256, error_fmt, args);
+    va_end(args);
+}
+
+static bool parse_entry(json_parser *parser, json_value **out);
+
+// Consumes the current character. Must only be called when input is available.
+static inline void consume(json_parser *parser)
+{
+    parser->cursor++;
+}
+
+// Checks if character is a blank (same set as isspace in the "C" locale).
+static inline bool is_blank(int c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Skips whitespace characters, keeping track of lines.
+static void skip_blank(json_parser *parser)
+{
+    while (has_input(parser))
+    {
+        char c = *parser->cursor;
+        if (c == '\n')
+        {
+            parser->line++;
+            parser->line_start = input_offset(parser) + 1;
+        }
+        else if (!is_blank(c))
+            return;
+        parser->cursor++;
+    }
+}
+
+// Verifies that the next character is as expected. If not, reports error.
+static bool expect(json_parser *parser, char expected_c)
+{
+    int c = peek(parser);
+    if (c != expected_c)
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER,
+            "expected '%c', found '%c'", expected_c, c);
+        return true;
+    }
+
+    consume(parser);
+    skip_blank(parser);
+    return false;
+}
+
+// Allocates memory for the parsed tree, from the document arena when parsing into one.
+static void *parser_allocate(json_parser *parser, size_t size, size_t alignment)
+{
+    void *memory = parser->document ? arena_allocate(parser->document, size, alignment) : pool_allocate(size);
+    if (!memory)
+        report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't allocate memory");
+    return memory;
+}
+
+// Releases memory from parser_allocate that didn't make it into the parsed tree.
+static void parser_release(json_parser *parser, void *memory)
+{
+    if (!parser->document)
+        free(memory);
+}
+
+// Creates a value of the given type for the parsed tree.
+static json_value *parser_new_value(json_parser *parser, json_type type)
+{
+    json_value *value = parser_allocate(parser, sizeof(json_value), _Alignof(json_value));
+    if (!value) return NULL;
+
+    *value = (json_value) {0};
+    value->type = type;
+    if (parser->document)
+        value->flags = VALUE_IN_ARENA | CONTENT_IN_ARENA;
+    return value;
+}
+
+// Copies the scratch buffer into a string owned by the parsed tree.
+static char *parser_copy_scratch(json_parser *parser)
+{
+    size_t size = parser->scratch.size;
+    char *string = parser_allocate(parser, size + 1, 1);
+    if (!string) return NULL;
+
+    if (size)
+        memcpy(string, parser->scratch.data, size);
+    string[size] = '\0';
+    return string;
+}
+
+// Collects characters matching a predicate in the scratch buffer, which is returned.
+static bool get_string(json_parser *parser, bool (*predicate)(int c), const char **out)
+{
+    string_builder *builder = &parser->scratch;
+    builder->size = 0;
+    if (string_builder_ensure_capacity(builder, 0))
+        goto alloc_error;
+    builder->data[0] = '\0';
+
+    while (predicate(peek(parser)))
+    {
+        if (string_builder_append(builder, *parser->cursor))
+            goto alloc_error;
+        consume(parser);
+    }
+
+    *out = builder->data;
+    return false;
+
+alloc_error:
+    report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't reallocate string buffer");
+    return true;
+}
+
+// Converts a hexadecimal digit to its value. Returns -1 if invalid.
+static int hex_digit_to_value(int c)
+{
+    if ('0' <= c && c <= '9') return c - '0';
+    if ('a' <= c && c <= 'f') return c - 'a' + 10;
+    if ('A' <= c && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Parses 4 hexadecimal digits into a UTF-16 code unit.
+static bool parse_utf16_code_unit(json_parser *parser, uint32_t *out)
+{
+    uint32_t code_point = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        int c = peek(parser);
+        int digit = hex_digit_to_value(c);
+        if (digit < 0)
+        {
+            report_parsing_error(parser, JSON_ERROR_UNICODE, "invalid hexadecimal digit '%c'", c);
+            return true;
+        }
+        code_point = (code_point << 4) | digit;
+        consume(parser);
+    }
+    *out = code_point;
+    return false;
+}
+
+// Parses Unicode escape sequences, including surrogate pairs.
+static bool parse_utf16_escape(json_parser *parser, uint32_t *out)
+{
+    uint32_t code_point;
+    if (parse_utf16_code_unit(parser, &code_point)) return true;
+
+    if (code_point < 0xD800 || 0xDFFF < code_point)
+    {
+        *out = code_point;
+        return false;
+    }
+
+    if (0xDBFF < code_point)
+    {
+        report_parsing_error(parser, JSON_ERROR_UNICODE, "invalid high surrogate range U+%04X", code_point);
+        return true;
+    }
+
+    // Comma operators are evil, but this is the most readable way to do this.
+    if (peek(parser) != '\\' ||
+        (consume(parser), peek(parser)) != 'u')
+    {
+        report_parsing_error(parser, JSON_ERROR_UNICODE, "missing low surrogate after high surrogate U+%04X", code_point);
+        return true;
+    }
+    consume(parser);
+
+    uint32_t low_surrogate;
+    if (parse_utf16_code_unit(parser, &low_surrogate))
+        return true;
+
+    if (low_surrogate < 0xDC00 || 0xDFFF < low_surrogate)
+    {
+        report_parsing_error(parser, JSON_ERROR_UNICODE, "invalid low surrogate range U+%04X", low_surrogate);
+        return true;
+    }
+
+    code_point = 0x10000 + (((code_point & 0x3FF) << 10) + (low_surrogate & 0x3FF));
+    if (code_point > 0x10FFFF)
+    {
+        report_parsing_error(parser, JSON_ERROR_UNICODE, "invalid code point U+%04X", code_point);
+        return true;
+    }
+
+    *out = code_point;
+    return false;
+}
+
+// Processes current escape sequence.
+static bool consume_escaped_character(json_parser *parser, string_builder *builder)
+{
+    consume(parser);
+
+    int escape_sequence = peek(parser);
+    if (escape_sequence != EOF)
+        consume(parser);
+
+    char unescaped;
+    switch (escape_sequence)
+    {
+    case '"':  unescaped = '"';  break;
+    case '\\': unescaped = '\\'; break;
+    case '/':  unescaped = '/';  break;
+    case 'b':  unescaped = '\b'; break;
+    case 'f':  unescaped = '\f'; break;
+    case 'n':  unescaped = '\n'; break;
+    case 'r':  unescaped = '\r'; break;
+    case 't':  unescaped = '\t'; break;
+
+    case 'u':
+        {
+        uint32_t code_point;
+        if (parse_utf16_escape(parser, &code_point)) return true;
+        if (string_builder_append_utf_code_point(builder, code_point))
+            goto alloc_error;
+        return false;
+        }
+
+    default:
+        report_parsing_error(parser, JSON_ERROR_ESCAPE_SEQUENCE, "invalid escape sequence '%c'", escape_sequence);
+        return true;
+    }
+
+    if (string_builder_append(builder, unescaped))
+        goto alloc_error;
+    return false;
+
+alloc_error:
+    report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't reallocate string buffer");
+    return true;
+}
+
+// Checks if character interrupts a run of plain string characters.
+static inline bool is_string_special(unsigned char c)
+{
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+// Returns the first quote, backslash or control character of [data, end), or end.
+static const char *find_string_special(const char *data, const char *end)
+{
+#ifdef SIMD_CHUNK_SIZE
+    while (end - data >= SIMD_CHUNK_SIZE)
+    {
+        simd_chunk chunk = simd_load(data);
+        simd_chunk special = simd_or(
+            simd_or(simd_eq(chunk, simd_splat('"')), simd_eq(chunk, simd_splat('\\'))),
+            simd_eq(simd_min(chunk, simd_splat(0x1F)), chunk));
+
+        uint64_t mask = simd_mask(special);
+        if (mask)
+            return data + lowest_bit_index(mask);
+        data += SIMD_CHUNK_SIZE;
+    }
+#endif
+
+    // Test 8 bytes at once for a zero byte after XOR, or a byte below 0x20.
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    const uint64_t high_bits = ones * 0x80;
+    while (end - data >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        uint64_t quote = word ^ (ones * '"');
+        uint64_t backslash = word ^ (ones * '\\');
+        uint64_t special = ((quote - ones) & ~quote)
+            | ((backslash - ones) & ~backslash)
+            | ((word - ones * 0x20) & ~word);
+        if (special & high_bits)
+            break;
+        data += 8;
+    }
+
+    while (data != end && !is_string_special(*data))
+        data++;
+    return data;
+}
+
+// Returns the first quote or bracket of [data, end), or end.
+static const char *find_quote_or_bracket(const char *data, const char *end)
+{
+#ifdef SIMD_CHUNK_SIZE
+    while (end - data >= SIMD_CHUNK_SIZE)
+    {
+        // Setting bit 5 folds '[' onto '{' and ']' onto '}'.
+        simd_chunk chunk = simd_load(data);
+        simd_chunk folded = simd_or(chunk, simd_splat(0x20));
+        simd_chunk special = simd_or(simd_eq(chunk, simd_splat('"')),
+            simd_or(simd_eq(folded, simd_splat('{')), simd_eq(folded, simd_splat('}'))));
+
+        uint64_t mask = simd_mask(special);
+        if (mask)
+            return data + lowest_bit_index(mask);
+        data += SIMD_CHUNK_SIZE;
+    }
+#endif
+
+    while (data != end && *data != '"' && (*data | 0x20) != '{' && (*data | 0x20) != '}')
+        data++;
+    return data;
+}
+
+// Parses a JSON quoted string into the scratch buffer. Plain characters are
+// copied in runs, only escape sequences being handled one at a time.
+static bool get_quoted_string(json_parser *parser)
+{
+    int c = peek(parser);
+    if (c != '"')
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "expected '\"', found '%c'", c);
+        return true;
+    }
+    consume(parser);
+
+    string_builder *builder = &parser->scratch;
+    builder->size = 0;
+
+    while (has_input(parser))
+    {
+        const char *run_end = find_string_special(parser->cursor, parser->end);
+        if (run_end != parser->cursor)
+        {
+            if (string_builder_append_bytes(builder, parser->cursor, run_end - parser->cursor))
+                goto alloc_error;
+            parser->cursor = run_end;
+            continue;
+        }
+
+        c = (unsigned char)*parser->cursor;
+        if (c == '"' || c == '\n')
+            break;
+
+        if (c == '\\')
+        {
+            if (consume_escaped_character(parser, builder))
+                return true;
+            continue;
+        }
+
+        // Other control characters are accepted as they are.
+        if (string_builder_append(builder, c))
+            goto alloc_error;
+        consume(parser);
+    }
+
+    c = peek(parser);
+    if (c != '"')
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "expected '\"', found '%c'", c);
+        return true;
+    }
+    consume(parser);
+    return false;
+
+alloc_error:
+    report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't reallocate string buffer");
+    return true;
+}
+
+// Parses a JSON quoted string in place: escape sequences are decoded over the
+// characters of the string, which is then terminated where its closing quote was.
+static bool get_quoted_string_in_place(json_parser *parser, char **out, size_t *length)
+{
+    int c = peek(parser);
+    if (c != '"')
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "expected '\"', found '%c'", c);
+        return true;
+    }
+    consume(parser);
+
+    // The window aliases the in-situ buffer, decoded characters never outrun the cursor.
+    char *string = parser->insitu_buffer + (parser->cursor - parser->window);
+    char *write = string;
+
+    while (has_input(parser))
+    {
+        const char *run_end = find_string_special(parser->cursor, parser->end);
+        if (run_end != parser->cursor)
+        {
+            size_t size = run_end - parser->cursor;
+            char *read = parser->insitu_buffer + (parser->cursor - parser->window);
+            if (write != read)
+                memmove(write, read, size);
+            write += size;
+            parser->cursor = run_end;
+            continue;
+        }
+
+        c = (unsigned char)*parser->cursor;
+        if (c == '"' || c == '\n')
+            break;
+
+        if (c == '\\')
+        {
+            parser->scratch.size = 0;
+            if (consume_escaped_character(parser, &parser->scratch))
+                return true;
+            memcpy(write, parser->scratch.data, parser->scratch.size);
+            write += parser->scratch.size;
+            continue;
+        }
+
+        // Other control characters are accepted as they are.
+        *write++ = (char)c;
+        consume(parser);
+    }
+
+    c = peek(parser);
+    if (c != '"')
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "expected '\"', found '%c'", c);
+        return true;
+    }
+    consume(parser);
+
+    *write = '\0';
+    *out = string;
+    *length = write - string;
+    return false;
+}
+
+// Parses a JSON quoted string owned by the parsed tree, or borrowed from the
+// input buffer when parsing in situ.
+static char *parser_take_string(json_parser *parser)
+{
+    if (parser->insitu_buffer)
+    {
+        char *string;
+        size_t length;
+        return get_quoted_string_in_place(parser, &string, &length) ? NULL : string;
+    }
+
+    if (get_quoted_string(parser)) return NULL;
+    return parser_copy_scratch(parser);
+}
+
+// Releases a string from parser_take_string that didn't make it into the parsed tree.
+static void parser_release_string(json_parser *parser, char *string)
+{
+    if (!parser->insitu_buffer)
+        parser_release(parser, string);
+}
+
+// Parses the key of an object member, interned when the options give a key pool.
+static char *parser_take_key(json_parser *parser)
+{
+    json_key_pool *pool = parser->options->key_pool;
+    if (!pool) return parser_take_string(parser);
+
+    char *key;
+    size_t length;
+    if (parser->insitu_buffer)
+    {
+        if (get_quoted_string_in_place(parser, &key, &length)) return NULL;
+    }
+    else
+    {
+        if (get_quoted_string(parser)) return NULL;
+        if (string_builder_append(&parser->scratch, '\0'))
+            goto alloc_error;
+        key = parser->scratch.data;
+    }
+
+    key = intern_key(pool, key);
+    if (!key)
+        goto alloc_error;
+    return key;
+
+alloc_error:
+    report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't intern key");
+    return NULL;
+}
+
+// Releases a key from parser_take_key that didn't make it into the parsed tree.
+static void parser_release_key(json_parser *parser, char *key)
+{
+    if (!parser->options->key_pool)
+        parser_release_string(parser, key);
+}
+
+// Creates a JSON entry from a string, stored in the entry itself when short and copied.
+static bool parse_string(json_parser *parser, json_value **out)
+{
+    char *string;
+    size_t length;
+    if (parser->insitu_buffer)
+    {
+        if (get_quoted_string_in_place(parser, &string, &length)) return true;
+    }
+    else
+    {
+        if (get_quoted_string(parser)) return true;
+
+        length = parser->scratch.size;
+        if (length < SMALL_STRING_SIZE)
+        {
+            json_value *value = parser_new_value(parser, JSON_STRING);
+            if (!value) return true;
+
+            set_small_string(value, parser->scratch.data, length);
+            *out = value;
+            return false;
+        }
+
+        string = parser_copy_scratch(parser);
+        if (!string) return true;
+    }
+
+    json_value *value = parser_new_value(parser, JSON_STRING);
+    if (!value)
+    {
+        parser_release_string(parser, string);
+        return true;
+    }
+
+    if (parser->insitu_buffer)
+        value->flags |= TEXT_BORROWED;
+    value->string = string;
+    value->string_length = length;
+    *out = value;
+    return false;
+}
+
+// Checks if character can be part of a JSON identifier.
+static bool is_part_of_identifier(int c)
+{
+    return isalpha(c);
+}
+
+// Reads JSON identifiers (null, true, false) into the type and boolean of a value.
+static bool read_identifier(json_parser *parser, json_value *scalar)
+{
+    const char *buffer;
+    if (get_string(parser, is_part_of_identifier, &buffer))
+        return true;
+
+    if (!strcmp(buffer, "null"))
+        scalar->type = JSON_NULL;
+    else if (!strcmp(buffer, "true"))
+        scalar->type = JSON_BOOL, scalar->boolean = true;
+    else if (!strcmp(buffer, "false"))
+        scalar->type = JSON_BOOL, scalar->boolean = false;
+    else
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_IDENTIFIER, "unknown identifier '%s'", buffer);
+        return true;
+    }
+    return false;
+}
+
+// Parses JSON identifiers (null, true, false).
+static bool parse_identifier(json_parser *parser, json_value **out)
+{
+    json_value scalar = {0};
+    if (read_identifier(parser, &scalar))
+        return true;
+
+    json_value *value = parser_new_value(parser, scalar.type);
+    if (!value) return true;
+
+    value->boolean = scalar.boolean;
+    *out = value;
+    return false;
+}
+
+// Checks if character can be part of a number.
+static bool is_part_of_number(int c)
+{
+    return is_digit(c) || c == '+' || c == '-' || c == '.' || c == 'e' || c == 'E';
+}
+
+// Validates and converts a JSON number into the flags and number of a value. The number
+// is read in place, unless it may continue past the input window and is collected first.
+static bool read_number(json_parser *parser, json_value *scalar)
+{
+    const char *start = parser->cursor;
+    const char *end = start;
+    while (end != parser->end && is_part_of_number(*end))
+        end++;
+
+    if (end == parser->end && parser->read_more)
+    {
+        if (get_string(parser, is_part_of_number, &start))
+            return true;
+        end = start + parser->scratch.size;
+    }
+    else
+        parser->cursor = end;
+
+    int length = end - start > INT_MAX ? INT_MAX : (int)(end - start);
+    decimal_number decimal;
+    if (scan_decimal_number(start, end, &decimal))
+    {
+        report_parsing_error(parser, JSON_ERROR_NUMBER_FORMAT, "invalid number format '%.*s'", length, start);
+        return true;
+    }
+
+    // Integers are kept exact when they fit in 64 bits, except -0 which needs a double.
+    uint64_t magnitude;
+    scalar->type = JSON_NUMBER;
+    if (decimal.integer && !decimal_integer_magnitude(&decimal, end, &magnitude)
+        && (!decimal.negative || (magnitude != 0 && magnitude - 1 <= INT64_MAX)))
+    {
+        if (decimal.negative)
+        {
+            scalar->flags |= NUMBER_INT64;
+            scalar->integer = magnitude - 1 == INT64_MAX ? INT64_MIN : -(int64_t)magnitude;
+        }
+        else if (magnitude <= INT64_MAX)
+        {
+            scalar->flags |= NUMBER_INT64;
+            scalar->integer = (int64_t)magnitude;
+        }
+        else
+        {
+            scalar->flags |= NUMBER_UINT64;
+            scalar->unsigned_integer = magnitude;
+        }
+        return false;
+    }
+
+    double number;
+    if (decimal_to_double(&decimal, &number))
+    {
+        bool overflow;
+        if (convert_number_slowly(start, end - start, &number, &overflow))
+        {
+            report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't allocate number buffer");
+            return true;
+        }
+        if (overflow)
+        {
+            report_parsing_error(parser, JSON_ERROR_NUMBER_FORMAT, "number '%.*s' out of range", length, start);
+            return true;
+        }
+    }
+
+    scalar->number = number;
+    return false;
+}
+
+// Creates a number entry from a JSON number.
+static bool parse_number(json_parser *parser, json_value **out)
+{
+    json_value scalar = {0};
+    if (read_number(parser, &scalar))
+        return true;
+
+    json_value *value = parser_new_value(parser, JSON_NUMBER);
+    if (!value) return true;
+
+    // The flags tell which member of the union holds the number, all are copied with it.
+    value->flags |= scalar.flags;
+    value->unsigned_integer = scalar.unsigned_integer;
+    *out = value;
+    return false;
+}
+
+// Pushes a parsed value, and its key inside objects, on the parser stack.
+static bool push_parsed_value(json_parser *parser, char *key, json_value *value)
+{
+    parse_stack *stack = &parser->stack;
+    if (stack->size == stack->capacity)
+    {
+        size_t capacity = stack->capacity ? stack->capacity * 2 : INITIAL_PARSE_STACK_SIZE;
+
+        json_value **values = realloc(stack->values, capacity * sizeof(json_value*));
+        if (!values) goto alloc_error;
+        stack->values = values;
+
+        char **keys = realloc(stack->keys, capacity * sizeof(char*));
+        if (!keys) goto alloc_error;
+        stack->keys = keys;
+
+        stack->capacity = capacity;
+    }
+
+    stack->keys[stack->size] = key;
+    stack->values[stack->size++] = value;
+    return false;
+
+alloc_error:
+    report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't reallocate parser stack");
+    return true;
+}
+
+// Frees the values (and keys) pushed since base, when their container failed to parse.
+static void drop_parsed_values(json_parser *parser, size_t base)
+{
+    parse_stack *stack = &parser->stack;
+    while (stack->size > base)
+    {
+        stack->size--;
+        parser_release_key(parser, stack->keys[stack->size]);
+        json_free(stack->values[stack->size]);
+    }
+}
+
+// Creates the array holding the values pushed on the parser stack since base.
+static bool finish_parsed_array(json_parser *parser, size_t base, json_value **out)
+{
+    size_t length = parser->stack.size - base;
+    json_value *array_value = parser_new_value(parser, JSON_ARRAY);
+    if (!array_value) return true;
+
+    json_array *array = parser_allocate(parser, array_storage_size(length), _Alignof(json_array));
+    if (!array)
+    {
+        parser_release(parser, array_value);
+        return true;
+    }
+
+    array->length = length;
+    array->capacity = length;
+    if (length)
+        memcpy(array->entry, parser->stack.values + base, length * sizeof(json_value*));
+    parser->stack.size = base;
+
+    array_value->array = array;
+    *out = array_value;
+    return false;
+}
+
+// Parses a JSON array.
+static bool parse_array(json_parser *parser, json_value **out)
+{
+    if (expect(parser, '['))
+        return true;
+
+    size_t base = parser->stack.size;
+    int c;
+    bool first_entry = true;
+    while ((c = peek(parser)) != ']' && c != EOF)
+    {
+        if (!first_entry && expect(parser, ','))
+            goto clean_up;
+        first_entry = false;
+
+        json_value *this_entry;
+        if (parse_entry(parser, &this_entry))
+            goto clean_up;
+
+        if (push_parsed_value(parser, NULL, this_entry))
+        {
+            json_free(this_entry);
+            goto clean_up;
+        }
+    }
+
+    if (expect(parser, ']') || finish_parsed_array(parser, base, out))
+        goto clean_up;
+    return false;
+
+clean_up:
+    drop_parsed_values(parser, base);
+    return true;
+}
+
+// Hash set of the members of the object being parsed, by position from the base of the
+// object on the parser stack. Only built for objects large enough for scans to be slow.
+typedef struct member_set {
+    size_t *slots;
+    size_t capacity;
+} member_set;
+
+// Returns the stack position of the member with the given key in the object being
+// parsed, or the stack size.
+static size_t find_parsed_member(const json_parser *parser, size_t base, const member_set *set, const char *key)
+{
+    const parse_stack *stack = &parser->stack;
+    if (set->slots)
+    {
+        size_t mask = set->capacity - 1;
+        for (size_t slot = hash_key(key) & mask; set->slots[slot]; slot = (slot + 1) & mask)
+        {
+            size_t position = base + set->slots[slot] - 1;
+            if (!strcmp(stack->keys[position], key))
+                return position;
+        }
+        return stack->size;
+    }
+
+    size_t i = base;
+    while (i < stack->size && strcmp(stack->keys[i], key))
+        ++i;
+    return i;
+}
+
+// Records the member last pushed on the stack in the set, building the set once the object
+// is large enough and rebuilding it when half full. Without a set, members are scanned.
+static void index_parsed_member(json_parser *parser, size_t base, member_set *set)
+{
+    size_t count = parser->stack.size - base;
+    if (set->slots && count * 2 <= set->capacity)
+    {
+        index_member(set->slots, set->capacity, parser->stack.keys[parser->stack.size - 1], count - 1);
+        return;
+    }
+    if (count < OBJECT_INDEX_THRESHOLD)
+        return;
+
+    free(set->slots);
+    set->capacity = object_index_capacity(count);
+    set->slots = calloc(set->capacity, sizeof(size_t));
+    if (!set->slots)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+        index_member(set->slots, set->capacity, parser->stack.keys[base + i], i);
+}
+
+// Adds a member to the object being parsed, handling duplicate keys as the options say.
+static bool add_parsed_member(json_parser *parser, size_t base, member_set *set, char *key, json_value *value)
+{
+    parse_stack *stack = &parser->stack;
+    json_duplicate_keys policy = parser->options->duplicate_keys;
+    size_t position = policy == JSON_DUPLICATE_KEYS_KEEP_ALL ? stack->size : find_parsed_member(parser, base, set, key);
+    if (position < stack->size)
+    {
+        if (policy == JSON_DUPLICATE_KEYS_ERROR)
+        {
+            report_parsing_error(parser, JSON_ERROR_DUPLICATE_KEY, "duplicate key '%s'", key);
+            parser_release_key(parser, key);
+            json_free(value);
+            return true;
+        }
+
+        if (policy == JSON_DUPLICATE_KEYS_FIRST_WINS)
+            json_free(value);
+        else
+        {
+            json_free(stack->values[position]);
+            stack->values[position] = value;
+        }
+        parser_release_key(parser, key);
+        return false;
+    }
+
+    if (push_parsed_value(parser, key, value))
+    {
+        parser_release_key(parser, key);
+        json_free(value);
+        return true;
+    }
+
+    if (policy != JSON_DUPLICATE_KEYS_KEEP_ALL)
+        index_parsed_member(parser, base, set);
+    return false;
+}
+
+// Creates the object holding the members pushed on the parser stack since base.
+static bool finish_parsed_object(json_parser *parser, size_t base, json_value **out)
+{
+    size_t size = parser->stack.size - base;
+    json_value *object_value = parser_new_value(parser, JSON_OBJECT);
+    if (!object_value) return true;
+
+    json_object *object = parser_allocate(parser, object_storage_size(size), _Alignof(json_object));
+    char **keys = NULL;
+    if (object && size)
+        keys = parser_allocate(parser, size * sizeof(char*), _Alignof(char*));
+    if (!object || (size && !keys))
+    {
+        parser_release(parser, object);
+        parser_release(parser, object_value);
+        return true;
+    }
+
+    // Wide objects get either an index or, frozen, their positions sorted by key.
+    bool frozen = parser->options->freeze_objects && size >= OBJECT_INDEX_THRESHOLD;
+    size_t index_capacity = size < OBJECT_INDEX_THRESHOLD || frozen ? 0 : object_index_capacity(size);
+    size_t index_size = frozen ? size : index_capacity;
+    size_t *index = NULL;
+    if (index_size)
+    {
+        index = parser_allocate(parser, index_size * sizeof(size_t), _Alignof(size_t));
+        if (!index)
+            goto alloc_error;
+    }
+
+    object->size = size;
+    object->capacity = size;
+    object->keys = keys;
+    object->index = frozen ? NULL : index;
+    object->index_capacity = index_capacity;
+    object->sorted = frozen ? index : NULL;
+    if (size)
+    {
+        memcpy(object->entry, parser->stack.values + base, size * sizeof(json_value*));
+        memcpy(keys, parser->stack.keys + base, size * sizeof(char*));
+    }
+    if (frozen && sort_object_members(object, index))
+    {
+        report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't sort object keys");
+        goto alloc_error;
+    }
+    if (object->index)
+        fill_object_index(object);
+    parser->stack.size = base;
+
+    if (parser->insitu_buffer || parser->options->key_pool)
+        object_value->flags |= TEXT_BORROWED;
+    object_value->object = object;
+    *out = object_value;
+    return false;
+
+alloc_error:
+    parser_release(parser, index);
+    parser_release(parser, keys);
+    parser_release(parser, object);
+    parser_release(parser, object_value);
+    return true;
+}
+
+// Parses a JSON object.
+static bool parse_object(json_parser *parser, json_value **out)
+{
+    if (expect(parser, '{'))
+        return true;
+
+    size_t base = parser->stack.size;
+    member_set members = {0};
+    int c;
+    bool first_entry = true;
+    while ((c = peek(parser)) != '}' && c != EOF)
+    {
+        if (!first_entry && expect(parser, ','))
+            goto clean_up;
+        first_entry = false;
+
+        char *key_string = parser_take_key(parser);
+        if (!key_string)
+            goto clean_up;
+
+        skip_blank(parser);
+        if (expect(parser, ':'))
+        {
+            parser_release_key(parser, key_string);
+            goto clean_up;
+        }
+
+        json_value *this_entry;
+        if (parse_entry(parser, &this_entry))
+        {
+            parser_release_key(parser, key_string);
+            goto clean_up;
+        }
+
+        if (add_parsed_member(parser, base, &members, key_string, this_entry))
+            goto clean_up;
+    }
+
+    if (expect(parser, '}') || finish_parsed_object(parser, base, out))
+        goto clean_up;
+    free(members.slots);
+    return false;
+
+clean_up:
+    free(members.slots);
+    drop_parsed_values(parser, base);
+    return true;
+}
+
+// Moves past the array or object at the cursor, only matching brackets outside of strings
+// and checking their nesting. The rest of the syntax is checked when the container is parsed.
+static bool skip_container(json_parser *parser)
+{
+    // Closing bracket expected at each depth.
+    string_builder *closers = &parser->scratch;
+    closers->size = 0;
+
+    const char *data = parser->cursor;
+    while ((data = find_quote_or_bracket(data, parser->end)) != parser->end)
+    {
+        char c = *data++;
+        if (c == '[' || c == '{')
+        {
+            if (closers->size && parser->depth + closers->size > parser->options->max_depth)
+            {
+                parser->cursor = data - 1;
+                report_parsing_error(parser, JSON_ERROR_MAX_DEPTH, "maximum depth (%zu) exceeded", parser->options->max_depth);
+                return true;
+            }
+            if (string_builder_append(closers, c == '[' ? ']' : '}'))
+            {
+                report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't allocate nesting stack");
+                return true;
+            }
+        }
+        else if (c != '"')
+        {
+            char expected = closers->data[--closers->size];
+            if (c != expected)
+            {
+                parser->cursor = data - 1;
+                report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "expected '%c', found '%c'", expected, c);
+                return true;
+            }
+            if (closers->size == 0)
+            {
+                parser->cursor = data;
+                return false;
+            }
+        }
+        else while ((data = find_string_special(data, parser->end)) != parser->end)
+        {
+            c = *data++;
+            if (c == '"')
+                break;
+            if (c == '\\' && data != parser->end)
+                data++;
+        }
+    }
+
+    parser->cursor = parser->end;
+    report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "unterminated nested array or object");
+    return true;
+}
+
+// Skips a nested array or object, creating a container that parses it on first access.
+static bool defer_container(json_parser *parser, json_value **out)
+{
+    const char *start = parser->cursor;
+    json_type type = *start == '[' ? JSON_ARRAY : JSON_OBJECT;
+    if (skip_container(parser))
+        return true;
+
+    json_value *value = parser_new_value(parser, type);
+    if (!value) return true;
+
+    lazy_container *lazy = parser_allocate(parser, sizeof(lazy_container), _Alignof(lazy_container));
+    if (!lazy)
+    {
+        parser_release(parser, value);
+        return true;
+    }
+
+    if (!parser->lazy_source)
+    {
+        lazy_source *source = parser_allocate(parser, sizeof(lazy_source), _Alignof(lazy_source));
+        if (!source)
+        {
+            parser_release(parser, lazy);
+            parser_release(parser, value);
+            return true;
+        }
+
+        // The parser holds a reference until it ends, deferred containers may be dropped before.
+        *source = (lazy_source) {
+            .references = 1,
+            .input = parser->window,
+            .insitu_buffer = parser->insitu_buffer,
+            .document = parser->document,
+            .max_depth = parser->options->max_depth,
+            .duplicate_keys = parser->options->duplicate_keys,
+            .key_pool = parser->options->key_pool,
+            .freeze_objects = parser->options->freeze_objects
+        };
+        parser->lazy_source = source;
+    }
+    parser->lazy_source->references++;
+
+    *lazy = (lazy_container) {
+        .source = parser->lazy_source,
+        .start = start,
+        .length = parser->cursor - start,
+        .depth = parser->depth
+    };
+    value->flags |= LAZY_CONTENT;
+    value->lazy = lazy;
+    *out = value;
+    return false;
+}
+
+// Determines the JSON type and parse the corresponding entry.
+static bool parse_entry(json_parser *parser, json_value **out)
+{
+    parser->depth++;
+    if (parser->depth > parser->options->max_depth)
+    {
+        report_parsing_error(parser, JSON_ERROR_MAX_DEPTH, "maximum depth (%zu) exceeded", parser->options->max_depth);
+        return true;
+    }
+
+    int c = peek(parser);
+    bool error = true;
+    if ((c == '[' || c == '{') && parser->defer_depth && parser->depth > parser->defer_depth)
+        error = defer_container(parser, out);
+    else if (c == '[')
+        error = parse_array(parser, out);
+    else if (c == '{')
+        error = parse_object(parser, out);
+    else if (c == '"')
+        error = parse_string(parser, out);
+    else if (isalpha(c))
+        error = parse_identifier(parser, out);
+    else if (isdigit(c) || c == '-')
+        error = parse_number(parser, out);
+    else
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "unexpected character '%c'", c);
+
+    if (!error)
+        skip_blank(parser);
+    parser->depth--;
+
+    return error;
+}
+
+// ----------
+// Structural Index
+// ----------
+
+// In structural index mode, a first pass over the input records the offset of
+// every structural character, opening quote and scalar start. Values are then
+// built by walking that index, the bytes in between being only blanks, string
+// contents and the remaining characters of scalars.
+
+// Bitmasks of the characters of interest in a 64-byte block, one bit per byte.
+typedef struct block_masks {
+    uint64_t backslash;
+    uint64_t quote;
+    uint64_t structural;
+    uint64_t blank;
+} block_masks;
+
+#ifdef SIMD_CHUNK_SIZE
+
+// Classifies the characters of a 64-byte block.
+static void classify_block(const char *block, block_masks *masks)
+{
+    *masks = (block_masks) {0};
+    for (unsigned i = 0; i < 64; i += SIMD_CHUNK_SIZE)
+    {
+        simd_chunk chunk = simd_load(block + i);
+
+        // '[' and ']' only differ from '{' and '}' by the 0x20 bit.
+        simd_chunk braces = simd_or(chunk, simd_splat(0x20));
+        simd_chunk structural = simd_or(
+            simd_or(simd_eq(braces, simd_splat('{')), simd_eq(braces, simd_splat('}'))),
+            simd_or(simd_eq(chunk, simd_splat(':')), simd_eq(chunk, simd_splat(','))));
+
+        // '\t' to '\r' are contiguous, so they are the bytes where (c - '\t') <= 4.
+        simd_chunk control = simd_sub(chunk, simd_splat('\t'));
+        simd_chunk blank = simd_or(simd_eq(chunk, simd_splat(' ')),
+            simd_eq(simd_min(control, simd_splat(4)), control));
+
+        masks->backslash |= simd_mask(simd_eq(chunk, simd_splat('\\'))) << i;
+        masks->quote |= simd_mask(simd_eq(chunk, simd_splat('"'))) << i;
+        masks->structural |= simd_mask(structural) << i;
+        masks->blank |= simd_mask(blank) << i;
+    }
+}
+
+#else
+
+// Classifies the characters of a 64-byte block.
+static void classify_block(const char *block, block_masks *masks)
+{
+    *masks = (block_masks) {0};
+    for (unsigned i = 0; i < 64; ++i)
+    {
+        uint64_t bit = (uint64_t)1 << i;
+        switch (block[i])
+        {
+        case '\\': masks->backslash |= bit; break;
+        case '"':  masks->quote |= bit; break;
+        case '{': case '}': case '[': case ']': case ':': case ',':
+            masks->structural |= bit;
+            break;
+        case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+            masks->blank |= bit;
+            break;
+        default: break;
+        }
+    }
+}
+
+#endif
+
+// Returns the mask of the characters escaped by a backslash. Runs of backslashes
+// escape every other character, and a run can carry over from the previous block.
+static uint64_t find_escaped(uint64_t backslash, uint64_t *carry)
+{
+    const uint64_t even_bits = UINT64_C(0x5555555555555555);
+
+    backslash &= ~*carry;
+    uint64_t follows_escape = backslash << 1 | *carry;
+
+    // Adding the starts of runs beginning on odd bits flips the parity of those runs.
+    uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t sequences = odd_starts + backslash;
+    *carry = sequences < backslash;
+
+    return (even_bits ^ (sequences << 1)) & follows_escape;
+}
+
+// Computes the running XOR of the bits, turning quote positions into string ranges.
+static uint64_t prefix_xor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Records the offsets of the structural characters, opening quotes and scalar
+// starts of the whole input in the structural index.
+static bool index_structurals(json_parser *parser)
+{
+    const char *input = parser->window;
+    size_t length = parser->end - parser->window;
+
+    uint64_t escape_carry = 0, in_string_carry = 0, scalar_carry = 0;
+    for (size_t offset = 0; offset < length; offset += 64)
+    {
+        if (parser->structural_capacity - parser->structural_count < 64)
+        {
+            size_t capacity = parser->structural_capacity ? parser->structural_capacity * 2 : length / 8 + 64;
+            uint32_t *structurals = realloc(parser->structurals, capacity * sizeof(uint32_t));
+            if (!structurals)
+            {
+                report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't allocate structural index");
+                return true;
+            }
+            parser->structurals = structurals;
+            parser->structural_capacity = capacity;
+        }
+
+        block_masks masks;
+        if (length - offset >= 64)
+            classify_block(input + offset, &masks);
+        else
+        {
+            // Pad the last block with blanks, which never start anything.
+            char block[64];
+            memset(block, ' ', sizeof(block));
+            memcpy(block, input + offset, length - offset);
+            classify_block(block, &masks);
+        }
+
+        uint64_t quote = masks.quote & ~find_escaped(masks.backslash, &escape_carry);
+        uint64_t in_string = prefix_xor(quote) ^ in_string_carry;
+        in_string_carry = 0 - (in_string >> 63);
+
+        uint64_t scalar = ~(masks.structural | masks.blank | masks.quote | in_string);
+        uint64_t scalar_start = scalar & ~(scalar << 1 | scalar_carry);
+        scalar_carry = scalar >> 63;
+
+        uint64_t structural = (masks.structural & ~in_string) | (quote & in_string) | scalar_start;
+        while (structural)
+        {
+            parser->structurals[parser->structural_count++] = (uint32_t)(offset + lowest_bit_index(structural));
+            structural &= structural - 1;
+        }
+    }
+    return false;
+}
+
+// Moves the cursor to the next indexed character and returns it, or EOF past the last one.
+static int next_structural(json_parser *parser)
+{
+    if (parser->next_structural == parser->structural_count)
+    {
+        parser->cursor = parser->end;
+        return EOF;
+    }
+
+    parser->cursor = parser->window + parser->structurals[parser->next_structural++];
+    return (unsigned char)*parser->cursor;
+}
+
+// Returns the next indexed character without moving to it, or EOF past the last one.
+static int peek_structural(const json_parser *parser)
+{
+    if (parser->next_structural == parser->structural_count)
+        return EOF;
+    return (unsigned char)parser->window[parser->structurals[parser->next_structural]];
+}
+
+// Builds a number or identifier, which mustn't be directly followed by other
+// characters since the index skips over the remaining characters of scalars.
+static bool build_scalar(json_parser *parser, int c, json_value **out)
+{
+    json_value *scalar;
+    if (isalpha(c) ? parse_identifier(parser, &scalar) : parse_number(parser, &scalar))
+        return true;
+
+    c = parser->cursor != parser->end ? (unsigned char)*parser->cursor : EOF;
+    if (c != EOF && !is_blank(c) && c != '"' && c != ',' && c != ':'
+        && c != '[' && c != ']' && c != '{' && c != '}')
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "unexpected character '%c'", c);
+        json_free(scalar);
+        return true;
+    }
+
+    *out = scalar;
+    return false;
+}
+
+static bool build_entry(json_parser *parser, json_value **out);
+
+// Builds a JSON array from the structural index, the cursor being on '['.
+static bool build_array(json_parser *parser, json_value **out)
+{
+    size_t base = parser->stack.size;
+    int c;
+    if (peek_structural(parser) == ']')
+        next_structural(parser);
+    else do
+    {
+        json_value *this_entry;
+        if (build_entry(parser, &this_entry))
+            goto clean_up;
+
+        if (push_parsed_value(parser, NULL, this_entry))
+        {
+            json_free(this_entry);
+            goto clean_up;
+        }
+
+        c = next_structural(parser);
+        if (c != ',' && c != ']')
+        {
+            report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER,
+                "expected ',' or ']', found '%c'", c);
+            goto clean_up;
+        }
+    } while (c == ',');
+
+    if (finish_parsed_array(parser, base, out))
+        goto clean_up;
+    return false;
+
+clean_up:
+    drop_parsed_values(parser, base);
+    return true;
+}
+
+// Builds a JSON object from the structural index, the cursor being on '{'.
+static bool build_object(json_parser *parser, json_value **out)
+{
+    size_t base = parser->stack.size;
+    member_set members = {0};
+    int c;
+    if (peek_structural(parser) == '}')
+        next_structural(parser);
+    else do
+    {
+        c = next_structural(parser);
+        if (c != '"')
+        {
+            report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "expected '\"', found '%c'", c);
+            goto clean_up;
+        }
+
+        char *key_string = parser_take_key(parser);
+        if (!key_string)
+            goto clean_up;
+
+        if ((c = next_structural(parser)) != ':')
+        {
+            report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "expected ':', found '%c'", c);
+            parser_release_key(parser, key_string);
+            goto clean_up;
+        }
+
+        json_value *this_entry;
+        if (build_entry(parser, &this_entry))
+        {
+            parser_release_key(parser, key_string);
+            goto clean_up;
+        }
+
+        if (add_parsed_member(parser, base, &members, key_string, this_entry))
+            goto clean_up;
+
+        c = next_structural(parser);
+        if (c != ',' && c != '}')
+        {
+            report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER,
+                "expected ',' or '}', found '%c'", c);
+            goto clean_up;
+        }
+    } while (c == ',');
+
+    if (finish_parsed_object(parser, base, out))
+        goto clean_up;
+    free(members.slots);
+    return false;
+
+clean_up:
+    free(members.slots);
+    drop_parsed_values(parser, base);
+    return true;
+}
+
+// Builds the JSON entry starting at the next indexed character.
+static bool build_entry(json_parser *parser, json_value **out)
+{
+    parser->depth++;
+    if (parser->depth > parser->options->max_depth)
+    {
+        report_parsing_error(parser, JSON_ERROR_MAX_DEPTH, "maximum depth (%zu) exceeded", parser->options->max_depth);
+        return true;
+    }
+
+    int c = next_structural(parser);
+    bool error = true;
+    if (c == '[')
+        error = build_array(parser, out);
+    else if (c == '{')
+        error = build_object(parser, out);
+    else if (c == '"')
+        error = parse_string(parser, out);
+    else if (isalpha(c) || isdigit(c) || c == '-')
+        error = build_scalar(parser, c, out);
+    else
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "unexpected character '%c'", c);
+
+    parser->depth--;
+
+    return error;
+}
+
+// Frees the working buffers of the parser.
+static void free_parser_buffers(json_parser *parser)
+{
+    string_builder_free(&parser->scratch);
+    free(parser->stack.values);
+    free(parser->stack.keys);
+    parser->stack = (parse_stack) {0};
+    free(parser->structurals);
+    parser->structurals = NULL;
+
+    // Sources are only counted on the heap, documents own them otherwise.
+    if (parser->lazy_source && !parser->document && --parser->lazy_source->references == 0)
+        free(parser->lazy_source);
+    parser->lazy_source = NULL;
+}
+
+// Parses an in-memory input by indexing its structure, then building values from the index.
+static json_error parse_indexed(json_parser *parser, json_value **out)
+{
+    json_value *root = NULL;
+    if (index_structurals(parser))
+        goto clean_up;
+
+    if (parser->structural_count == 0)
+    {
+        free_parser_buffers(parser);
+        *out = NULL;
+        return JSON_SUCCESS;
+    }
+
+    if (build_entry(parser, &root))
+        goto clean_up;
+
+    if (next_structural(parser) != EOF)
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER,
+            "expected end of file, found '%c'", *parser->cursor);
+        goto clean_up;
+    }
+
+    free_parser_buffers(parser);
+    *out = root;
+    return JSON_SUCCESS;
+
+clean_up:
+    if (root)
+        json_free(root);
+    free_parser_buffers(parser);
+    return parser->error;
+}
+
+// Main entry point for parsing a JSON input.
+static json_error parse(json_parser *parser, json_value **out)
+{
+    parser->document = parser->options->document;
+    parser->line = 1;
+    parser->line_start = 0;
+    parser->depth = 0;
+    parser->error = JSON_SUCCESS;
+
+    // Deferred containers are parsed later from the in-memory input.
+    if (parser->options->lazy && !parser->read_more)
+        parser->defer_depth = 1;
+
+    // The index stores 32-bit offsets of a single in-memory window.
+    else if (parser->options->structural_index && !parser->read_more
+        && (size_t)(parser->end - parser->window) <= UINT32_MAX)
+        return parse_indexed(parser, out);
+
+    skip_blank(parser);
+
+    if (!has_input(parser))
+    {
+        *out = NULL;
+        return JSON_SUCCESS;
+    }
+
+    json_value *root = NULL;
+    if (parse_entry(parser, &root))
+        goto clean_up;
+
+    if (has_input(parser))
+    {
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER,
+            "expected end of file, found '%c'", *parser->cursor);
+        goto clean_up;
+    }
+
+    if (parser->input_error)
+        goto clean_up;
+
+    free_parser_buffers(parser);
+    *out = root;
+    return JSON_SUCCESS;
+
+clean_up:
+    // A read failure looks like a premature end of input, report it as such.
+    if (parser->input_error)
+        report_parsing_error(parser, JSON_ERROR_IO, "failed to read input");
+    if (root)
+        json_free(root);
+    free_parser_buffers(parser);
+    return parser->error;
+}
+
+// Parses a container deferred by a lazy parse, deferring in turn the containers it holds.
+// Errors are only located in the given error info, which the lazy parse doesn't keep.
+static json_error parse_deferred(lazy_container *lazy, json_error_info *error_info)
+{
+    lazy_source *source = lazy->source;
+    source->references++;
+
+    json_parse_options options = {
+        .max_depth = source->max_depth,
+        .document = source->document,
+        .duplicate_keys = source->duplicate_keys,
+        .key_pool = source->key_pool,
+        .freeze_objects = source->freeze_objects,
+        .lazy = true
+    };
+
+    // The window starts with the whole input, so that errors are located in it.
+    json_parser parser = {
+        .options = &options,
+        .error_info = error_info,
+        .document = source->document,
+        .insitu_buffer = source->insitu_buffer,
+        .lazy_source = source,
+        .defer_depth = lazy->depth,
+        .depth = lazy->depth - 1,
+        .line = 1
+    };
+    set_input_window(&parser, source->input, (size_t)(lazy->start - source->input) + lazy->length);
+    parser.cursor = lazy->start;
+
+    json_value *value = NULL;
+    if (parse_entry(&parser, &value))
+        goto clean_up;
+
+    if (has_input(&parser))
+    {
+        report_parsing_error(&parser, JSON_ERROR_UNEXPECTED_CHARACTER,
+            "expected end of nested value, found '%c'", *parser.cursor);
+        goto clean_up;
+    }
+
+    free_parser_buffers(&parser);
+    lazy->value = value;
+    return JSON_SUCCESS;
+
+clean_up:
+    if (value)
+        json_free(value);
+    free_parser_buffers(&parser);
+    return parser.error;
+}
+
+// --------------------
+// Input Source Functions
+// --------------------
+
+json_error json_parse_buffer(const char *buffer, size_t length, json_value **value, const json_parse_options *options)
+{
+    if (!value) return JSON_ERROR_NULL;
+    if (!options) options = &JSON_DEFAULT_PARSE_OPTIONS;
+
+    json_parser parser = {
+        .options = options,
+        .error_info = options->error_info
+    };
+
+    if (!buffer)
+    {
+        report_parsing_error(&parser, JSON_ERROR_NULL, "buffer is NULL");
+        return JSON_ERROR_NULL;
+    }
+
+    set_input_window(&parser, buffer, length);
+    return parse(&parser, value);
+}
+
+json_error json_parse_insitu(char *buffer, size_t length, json_value **value, const json_parse_options *options)
+{
+    if (!value) return JSON_ERROR_NULL;
+    if (!options) options = &JSON_DEFAULT_PARSE_OPTIONS;
+
+    json_parser parser = {
+        .options = options,
+        .error_info = options->error_info,
+        .insitu_buffer = buffer
+    };
+
+    if (!buffer)
+    {
+        report_parsing_error(&parser, JSON_ERROR_NULL, "buffer is NULL");
+        return JSON_ERROR_NULL;
+    }
+
+    set_input_window(&parser, buffer, length);
+    return parse(&parser, value);
+}
+
+json_error json_parse_string(const char *string, json_value **value, const json_parse_options *options)
+{
+    if (!value) return JSON_ERROR_NULL;
+    if (!options) options = &JSON_DEFAULT_PARSE_OPTIONS;
+
+    if (!string)
+    {
+        json_parser parser = {
+            .options = options,
+            .error_info = options->error_info
+        };
+        report_parsing_error(&parser, JSON_ERROR_NULL, "string is NULL");
+        return JSON_ERROR_NULL;
+    }
+
+    return json_parse_buffer(string, strlen(string), value, options);
+}
+
+// Reads the next block of the file into the read buffer.
+static size_t read_more_from_file(json_parser *parser)
+{
+    size_t size = fread(parser->read_buffer, 1, parser->read_buffer_size, parser->input_file);
+    if (size == 0)
+    {
+        parser->input_error = ferror(parser->input_file);
+        return 0;
+    }
+
+    set_input_window(parser, parser->read_buffer, size);
+    return size;
+}
+
+json_error json_parse_file(FILE *file, json_value **value, const json_parse_options *options)
+{
+    if (!value) return JSON_ERROR_NULL;
+    if (!options) options = &JSON_DEFAULT_PARSE_OPTIONS;
+
+    json_parser parser = {
+        .input_file = file,
+        .read_more = read_more_from_file,
+        .read_buffer_size = options->read_buffer_size ? options->read_buffer_size : DEFAULT_READ_BUFFER_SIZE,
+        .options = options,
+        .error_info = options->error_info
+    };
+
+    if (!file)
+    {
+        report_parsing_error(&parser, JSON_ERROR_NULL, "file is NULL");
+        return JSON_ERROR_NULL;
+    }
+
+    parser.read_buffer = malloc(parser.read_buffer_size);
+    if (!parser.read_buffer)
+    {
+        report_parsing_error(&parser, JSON_ERROR_ALLOCATION, "couldn't allocate read buffer");
+        return JSON_ERROR_ALLOCATION;
+    }
+
+    json_error error = parse(&parser, value);
+    free(parser.read_buffer);
+    return error;
+}
+
+// Parses a file through the stream interface, used when it can't be mapped.
+static json_error parse_path_stream(const char *path, json_value **value, const json_parse_options *options)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        json_parser parser = {
+            .options = options,
+            .error_info = options->error_info
+        };
+        report_parsing_error(&parser, JSON_ERROR_IO, "couldn't open '%s'", path);
+        return JSON_ERROR_IO;
+    }
+
+    json_error error = json_parse_file(file, value, options);
+    fclose(file);
+    return error;
+}
+
+json_error json_parse_path(const char *path, json_value **value, const json_parse_options *options)
+{
+    if (!value) return JSON_ERROR_NULL;
+    if (!options) options = &JSON_DEFAULT_PARSE_OPTIONS;
+
+    json_parser parser = {
+        .options = options,
+        .error_info = options->error_info
+    };
 
-    if (code_point < 0xD800 || 0xDFFF < code_point)
+    if (!path)
     {
-        *out = code_point;
-        return false;
+        report_parsing_error(&parser, JSON_ERROR_NULL, "path is NULL");
+        return JSON_ERROR_NULL;
     }
 
-    if (0xDBFF < code_point)
+#ifdef JSON_HAS_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
     {
-        report_parsing_error(parser, JSON_ERROR_UNICODE, "invalid high surrogate range U+%04X", code_point);
-        return true;
+        report_parsing_error(&parser, JSON_ERROR_IO, "couldn't open '%s'", path);
+        return JSON_ERROR_IO;
     }
 
-    // Comma operators are evil, but this is the most readable way to do this.
-    if (parser->last_c != '\\' ||
-        (consume(parser), parser->last_c) != 'u')
+    // Only regular files can be mapped, anything else (pipes, devices...) is streamed.
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) || !S_ISREG(file_stat.st_mode)
+        || (uintmax_t)file_stat.st_size > SIZE_MAX)
     {
-        report_parsing_error(parser, JSON_ERROR_UNICODE, "missing low surrogate after high surrogate U+%04X", code_point);
-        return true;
+        close(fd);
+        return parse_path_stream(path, value, options);
     }
-    consume(parser);
-
-    uint32_t low_surrogate;
-    if (parse_utf16_code_unit(parser, &low_surrogate))
-        return true;
-
-    if (low_surrogate < 0xDC00 || 0xDFFF < low_surrogate)
-    {
-        report_parsing_error(parser, JSON_ERROR_UNICODE, "invalid low surrogate range U+%04X", low_surrogate);
-        return true;
-    }  
 
-    code_point = 0x10000 + (((code_point & 0x3FF) << 10) + (low_surrogate & 0x3FF));
-    if (code_point > 0x10FFFF)
+    size_t size = (size_t)file_stat.st_size;
+    if (size == 0)
     {
-        report_parsing_error(parser, JSON_ERROR_UNICODE, "invalid code point U+%04X", code_point);
-        return true;
+        close(fd);
+        return json_parse_buffer("", 0, value, options);
     }
 
-    *out = code_point;
-    return false;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return parse_path_stream(path, value, options);
+
+    posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+
+    // The mapping is released on return, so nothing can be left to parse from it later.
+    json_parse_options mapped_options = *options;
+    mapped_options.lazy = false;
+    json_error error = json_parse_buffer(mapping, size, value, &mapped_options);
+    munmap(mapping, size);
+    return error;
+#else
+    return parse_path_stream(path, value, options);
+#endif
 }
 
-// Processes current escape sequence.
-static bool consume_escaped_character(json_parser *parser, string_builder *builder)
+json_error json_parse_deferred(json_value *value, json_error_info *error_info)
 {
-    if (expect(parser, '\\'))
-        return true;
+    if (!value) return JSON_ERROR_NULL;
 
-    char escape_sequence = parser->last_c;
-    consume(parser);
+    const json_value *entry = value;
+    while (entry->flags & SHARED_CONTENT)
+        entry = entry->shared->content;
+    if (!(entry->flags & LAZY_CONTENT) || entry->lazy->value)
+        return JSON_SUCCESS;
+    return parse_deferred(entry->lazy, error_info);
+}
 
-    switch (escape_sequence)
-    {
-    case '"':  return string_builder_append(builder, '"');  break;
-    case '\\': return string_builder_append(builder, '\\'); break;
-    case '/':  return string_builder_append(builder, '/');  break;
-    case 'b':  return string_builder_append(builder, '\b'); break;
-    case 'f':  return string_builder_append(builder, '\f'); break;
-    case 'n':  return string_builder_append(builder, '\n'); break;
-    case 'r':  return string_builder_append(builder, '\r'); break;
-    case 't':  return string_builder_append(builder, '\t'); break;
+// --------------------
+// Tape Documents
+// --------------------
 
-    case 'u':
-        {
-        uint32_t code_point;
-        if (parse_utf16_escape(parser, &code_point)) return true;
-        return string_builder_append_utf_code_point(builder, code_point);
-        }
+// A tape stores a parsed value as a sequence of 64-bit words, each tagged in its top byte.
+// Scalars take one word, followed by the bits of the number for numbers. Strings give the
+// offset of their length and characters in the string buffer. Arrays and objects are
+// enclosed between a start word giving the position past their end, and an end word giving
+// their number of values. The members of objects are their key followed by their value.
+enum {
+    TAPE_NULL         = 'n',
+    TAPE_TRUE         = 't',
+    TAPE_FALSE        = 'f',
+    TAPE_INT64        = 'l',
+    TAPE_UINT64       = 'u',
+    TAPE_DOUBLE       = 'd',
+    TAPE_STRING       = '"',
+    TAPE_ARRAY_START  = '[',
+    TAPE_ARRAY_END    = ']',
+    TAPE_OBJECT_START = '{',
+    TAPE_OBJECT_END   = '}'
+};
 
-    default:
-        report_parsing_error(parser, JSON_ERROR_ESCAPE_SEQUENCE, "invalid escape sequence '%c'", parser->last_c);
-        return true;
-    }
+static const size_t TAPE_INITIAL_CAPACITY = 64;
+static const uint64_t TAPE_PAYLOAD_MASK = (UINT64_C(1) << 56) - 1;
+
+struct json_tape {
+    uint64_t *words;
+    size_t length;
+    size_t capacity;
+    string_builder strings;
+};
+
+static uint64_t tape_word(int tag, uint64_t payload)
+{
+    return (uint64_t)tag << 56 | payload;
 }
 
-// Parses and returns a JSON quoted string.
-static bool get_quoted_string(json_parser *parser, char **out)
+static int tape_tag(const json_tape *tape, size_t index)
 {
-    if (expect(parser, '"'))
-        return true;
+    return (int)(tape->words[index] >> 56);
+}
 
-    string_builder builder = {0};
+static uint64_t tape_payload(const json_tape *tape, size_t index)
+{
+    return tape->words[index] & TAPE_PAYLOAD_MASK;
+}
+
+// Returns the position following the value at the given position.
+static size_t tape_skip(const json_tape *tape, size_t index)
+{
+    switch (tape_tag(tape, index))
+    {
+    case TAPE_ARRAY_START:
+    case TAPE_OBJECT_START: return (size_t)tape_payload(tape, index);
+    case TAPE_INT64:
+    case TAPE_UINT64:
+    case TAPE_DOUBLE: return index + 2;
+    default: return index + 1;
+    }
+}
 
-    while (parser->last_c != '"'
-        && parser->last_c != EOF
-        && parser->last_c != '\n')
+// Returns the characters of the string at the given position, and their length.
+static const char *tape_string_text(const json_tape *tape, size_t index, size_t *length)
+{
+    const char *text = tape->strings.data + tape_payload(tape, index);
+    memcpy(length, text, sizeof(size_t));
+    return text + sizeof(size_t);
+}
+
+static bool tape_append(json_parser *parser, json_tape *tape, uint64_t word)
+{
+    if (tape->length == tape->capacity)
     {
-        if (parser->last_c == '\\')
+        size_t capacity = tape->capacity ? tape->capacity * 2 : TAPE_INITIAL_CAPACITY;
+        uint64_t *words = capacity <= SIZE_MAX / sizeof(uint64_t) ? realloc(tape->words, capacity * sizeof(uint64_t)) : NULL;
+        if (!words)
         {
-            if (consume_escaped_character(parser, &builder))
-                goto clean_up;
-            continue;
+            report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't reallocate tape");
+            return true;
         }
-
-        if (string_builder_append(&builder, parser->last_c))
-            goto alloc_error;
-        consume(parser);
+        tape->words = words;
+        tape->capacity = capacity;
     }
 
-    if (expect(parser, '"'))
-        goto clean_up;
-    
-    if (string_builder_build(&builder, out))
-        goto alloc_error;
+    tape->words[tape->length++] = word;
     return false;
-
-alloc_error:
-    report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't reallocate string buffer");
-clean_up:
-    string_builder_free(&builder);
-    return true;
 }
 
-// Creates a JSON entry from a string.
-static bool parse_string(json_parser *parser, json_value **out)
+// Appends a scalar read by read_identifier or read_number to the tape.
+static bool tape_append_scalar(json_parser *parser, json_tape *tape, const json_value *scalar)
 {
-    char *string;
-    if (get_quoted_string(parser, &string)) return true;
-    return json_string_create_nocopy(string, out);
+    if (scalar->type == JSON_NULL)
+        return tape_append(parser, tape, tape_word(TAPE_NULL, 0));
+    if (scalar->type == JSON_BOOL)
+        return tape_append(parser, tape, tape_word(scalar->boolean ? TAPE_TRUE : TAPE_FALSE, 0));
+
+    int tag = scalar->flags & NUMBER_INT64 ? TAPE_INT64 : scalar->flags & NUMBER_UINT64 ? TAPE_UINT64 : TAPE_DOUBLE;
+    return tape_append(parser, tape, tape_word(tag, 0)) || tape_append(parser, tape, scalar->unsigned_integer);
 }
 
-// Checks if character can be part of a JSON identifier.
-static bool is_part_of_identifier(int c)
+// Parses a JSON quoted string into the string buffer of the tape, preceded by its length.
+static bool tape_string(json_parser *parser, json_tape *tape)
 {
-    return isalpha(c);
+    if (get_quoted_string(parser)) return true;
+
+    size_t length = parser->scratch.size;
+    uint64_t offset = tape->strings.size;
+    if (string_builder_append_bytes(&tape->strings, (const char*)&length, sizeof(size_t))
+        || (length && string_builder_append_bytes(&tape->strings, parser->scratch.data, length))
+        || string_builder_append(&tape->strings, '\0'))
+    {
+        report_parsing_error(parser, JSON_ERROR_ALLOCATION, "couldn't reallocate tape strings");
+        return true;
+    }
+    return tape_append(parser, tape, tape_word(TAPE_STRING, offset));
 }
 
-// Parses JSON identifiers (null, true, false).
-static bool parse_identifier(json_parser *parser, json_value **out)
+static bool tape_entry(json_parser *parser, json_tape *tape);
+
+// Parses a JSON array or object into the tape, writing its start word once its end is known.
+static bool tape_container(json_parser *parser, json_tape *tape, int open, int close)
 {
-    char *buffer;
-    if (get_string(parser, is_part_of_identifier, &buffer))
+    if (expect(parser, (char)open))
         return true;
 
-    json_error error;
-    if (!strcmp(buffer, "null"))
-        error = json_null_create(out);
-    else if (!strcmp(buffer, "true"))
-        error = json_bool_create(true, out);
-    else if (!strcmp(buffer, "false"))
-        error = json_bool_create(false, out);
-    else
-    {
-        free(buffer);
-        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_IDENTIFIER, "unknown identifier '%s'", buffer);
+    size_t start = tape->length;
+    if (tape_append(parser, tape, 0))
         return true;
-    }
-    
-    free(buffer);
-    if (error != JSON_SUCCESS)
+
+    size_t count = 0;
+    int c;
+    while ((c = peek(parser)) != close && c != EOF)
     {
-        report_parsing_error(parser, error, "failed to create identifier '%s' entry", buffer);
-        return true;
+        if (count && expect(parser, ','))
+            return true;
+
+        if (close == TAPE_OBJECT_END)
+        {
+            if (tape_string(parser, tape))
+                return true;
+            skip_blank(parser);
+            if (expect(parser, ':'))
+                return true;
+        }
+
+        if (tape_entry(parser, tape))
+            return true;
+        count++;
     }
 
+    if (expect(parser, (char)close) || tape_append(parser, tape, tape_word(close, count)))
+        return true;
+    tape->words[start] = tape_word(open, tape->length);
     return false;
 }
 
-// Checks if character can be part of a number.
-static bool is_part_of_number(int c)
+// Parses a JSON value into the tape.
+static bool tape_entry(json_parser *parser, json_tape *tape)
 {
-    return isdigit(c) || c == '+' || c == '-' || c == '.' || c == 'e' || c == 'E';
+    parser->depth++;
+    if (parser->depth > parser->options->max_depth)
+    {
+        report_parsing_error(parser, JSON_ERROR_MAX_DEPTH, "maximum depth (%zu) exceeded", parser->options->max_depth);
+        return true;
+    }
+
+    int c = peek(parser);
+    json_value scalar = {0};
+    bool error = true;
+    if (c == '[')
+        error = tape_container(parser, tape, TAPE_ARRAY_START, TAPE_ARRAY_END);
+    else if (c == '{')
+        error = tape_container(parser, tape, TAPE_OBJECT_START, TAPE_OBJECT_END);
+    else if (c == '"')
+        error = tape_string(parser, tape);
+    else if (isalpha(c))
+        error = read_identifier(parser, &scalar) || tape_append_scalar(parser, tape, &scalar);
+    else if (isdigit(c) || c == '-')
+        error = read_number(parser, &scalar) || tape_append_scalar(parser, tape, &scalar);
+    else
+        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "unexpected character '%c'", c);
+
+    if (!error)
+        skip_blank(parser);
+    parser->depth--;
+
+    return error;
 }
 
-// Converts a string of digits (and other characters) into a JSON number entry.
-static bool parse_number(json_parser *parser, json_value **out)
+json_error json_parse_tape(const char *buffer, size_t length, json_tape **out, const json_parse_options *options)
 {
-    char *buffer;
-    if (get_string(parser, is_part_of_number, &buffer))
-        return true;
+    if (!out) return JSON_ERROR_NULL;
+    if (!options) options = &JSON_DEFAULT_PARSE_OPTIONS;
+
+    json_parser parser = {
+        .options = options,
+        .error_info = options->error_info,
+        .line = 1
+    };
 
-    char *number_end;
-    double number = strtod(buffer, &number_end);
-    char final_char = *number_end;
-    if (final_char != '\0')
+    if (!buffer)
     {
-        report_parsing_error(parser, JSON_ERROR_NUMBER_FORMAT, "invalid number format '%s'", buffer);
-        goto clean_up;
+        report_parsing_error(&parser, JSON_ERROR_NULL, "buffer is NULL");
+        return JSON_ERROR_NULL;
     }
-    if (errno == ERANGE)
+
+    set_input_window(&parser, buffer, length);
+    skip_blank(&parser);
+    if (!has_input(&parser))
+    {
+        *out = NULL;
+        return JSON_SUCCESS;
+    }
+
+    json_tape *tape = calloc(1, sizeof(json_tape));
+    if (!tape)
+    {
+        report_parsing_error(&parser, JSON_ERROR_ALLOCATION, "couldn't allocate tape");
+        return JSON_ERROR_ALLOCATION;
+    }
+
+    if (tape_entry(&parser, tape))
+        goto clean_up;
+
+    if (has_input(&parser))
     {
-        report_parsing_error(parser, JSON_ERROR_NUMBER_FORMAT, "number '%s' out of range", buffer);
+        report_parsing_error(&parser, JSON_ERROR_UNEXPECTED_CHARACTER,
+            "expected end of file, found '%c'", *parser.cursor);
         goto clean_up;
     }
-    free(buffer);
 
-    return json_number_create(number, out);
+    // The tape is complete, its room to grow is given back.
+    uint64_t *words = realloc(tape->words, tape->length * sizeof(uint64_t));
+    if (words)
+        tape->words = words, tape->capacity = tape->length;
+    char *strings = tape->strings.size ? realloc(tape->strings.data, tape->strings.size + 1) : NULL;
+    if (strings)
+        tape->strings.data = strings, tape->strings.allocated_size = tape->strings.size + 1;
+    free_parser_buffers(&parser);
+    *out = tape;
+    return JSON_SUCCESS;
 
 clean_up:
-    free(buffer);
-    return true;
+    json_tape_free(tape);
+    free_parser_buffers(&parser);
+    return parser.error;
 }
 
-// Parses a JSON array.
-static bool parse_array(json_parser *parser, json_value **out)
+void json_tape_free(json_tape *tape)
 {
-    if (expect(parser, '['))
-        return true;
+    if (!tape) return;
+    free(tape->words);
+    string_builder_free(&tape->strings);
+    free(tape);
+}
 
-    json_value *array_value;
-    json_error error = json_array_create(&array_value);
-    if (error)
-    {
-        report_parsing_error(parser, error, "failed to create array entry");
-        return true;
-    }
+json_error json_tape_root(const json_tape *tape, json_node *out)
+{
+    if (!tape || !out) return JSON_ERROR_NULL;
+    *out = (json_node) { .tape = tape, .index = 0, .parent_end = 0 };
+    return JSON_SUCCESS;
+}
 
-    bool first_entry = true;
-    while (parser->last_c != ']' && parser->last_c != EOF)
+// Fills a value with the scalar at the given position, or only the type of a container.
+static void load_tape_scalar(const json_tape *tape, size_t index, json_value *scalar)
+{
+    *scalar = (json_value) {0};
+    switch (tape_tag(tape, index))
     {
-        if (!first_entry && expect(parser, ','))
-            goto clean_up;
-        first_entry = false;
+    case TAPE_NULL:   scalar->type = JSON_NULL; break;
+    case TAPE_TRUE:   scalar->type = JSON_BOOL; scalar->boolean = true; break;
+    case TAPE_FALSE:  scalar->type = JSON_BOOL; break;
+    case TAPE_INT64:  scalar->type = JSON_NUMBER; scalar->flags = NUMBER_INT64; scalar->unsigned_integer = tape->words[index + 1]; break;
+    case TAPE_UINT64: scalar->type = JSON_NUMBER; scalar->flags = NUMBER_UINT64; scalar->unsigned_integer = tape->words[index + 1]; break;
+    case TAPE_DOUBLE: scalar->type = JSON_NUMBER; scalar->unsigned_integer = tape->words[index + 1]; break;
+    case TAPE_ARRAY_START:  scalar->type = JSON_ARRAY; break;
+    case TAPE_OBJECT_START: scalar->type = JSON_OBJECT; break;
+    default:
+        scalar->type = JSON_STRING;
+        scalar->flags = TEXT_BORROWED;
+        scalar->string = tape->strings.data + tape_payload(tape, index) + sizeof(size_t);
+        memcpy(&scalar->string_length, scalar->string - sizeof(size_t), sizeof(size_t));
+        break;
+    }
+}
 
-        json_value *this_entry;
-        if (parse_entry(parser, &this_entry))
-            goto clean_up;
+json_error json_node_get_type(json_node node, json_type *out)
+{
+    if (!node.tape || !out) return JSON_ERROR_NULL;
 
-        json_array_append(array_value, this_entry);
-    }
-    
-    if (expect(parser, ']'))
-        goto clean_up;
+    json_value scalar;
+    load_tape_scalar(node.tape, node.index, &scalar);
+    *out = scalar.type;
+    return JSON_SUCCESS;
+}
 
-    *out = array_value;
-    return false;
+json_error json_node_bool_get(json_node node, bool *out)
+{
+    if (!node.tape) return JSON_ERROR_NULL;
 
-clean_up:
-    json_free(array_value);
-    return true;
+    json_value scalar;
+    load_tape_scalar(node.tape, node.index, &scalar);
+    return json_bool_get(&scalar, out);
 }
 
-// Parses a JSON object.
-static bool parse_object(json_parser *parser, json_value **out)
+json_error json_node_number_get(json_node node, double *out)
 {
-    if (expect(parser, '{'))
-        return true;
+    if (!node.tape) return JSON_ERROR_NULL;
 
-    json_value *object_value;
-    json_error error = json_object_create(&object_value);
-    if (error)
-    {
-        report_parsing_error(parser, error, "failed to create object entry");
-        return true;
-    }
+    json_value scalar;
+    load_tape_scalar(node.tape, node.index, &scalar);
+    return json_number_get(&scalar, out);
+}
 
-    bool first_entry = true;
-    while (parser->last_c != '}' && parser->last_c != EOF)
-    {
-        if (!first_entry && expect(parser, ','))
-            goto clean_up;
-        first_entry = false;
+json_error json_node_integer_get(json_node node, int64_t *out)
+{
+    if (!node.tape) return JSON_ERROR_NULL;
 
-        char *key_string;
-        if (get_quoted_string(parser, &key_string))
-            goto clean_up;
+    json_value scalar;
+    load_tape_scalar(node.tape, node.index, &scalar);
+    return json_integer_get(&scalar, out);
+}
 
-        if (expect(parser, ':'))
-        {
-            free(key_string);
-            goto clean_up;
-        }
+json_error json_node_unsigned_get(json_node node, uint64_t *out)
+{
+    if (!node.tape) return JSON_ERROR_NULL;
 
-        json_value *this_entry;
-        if (parse_entry(parser, &this_entry))
-        {
-            free(key_string);
-            goto clean_up;
-        }
+    json_value scalar;
+    load_tape_scalar(node.tape, node.index, &scalar);
+    return json_unsigned_get(&scalar, out);
+}
 
-        json_object_set(object_value, key_string, this_entry);
-    }
+json_error json_node_string_get(json_node node, const char **out)
+{
+    if (!node.tape || !out) return JSON_ERROR_NULL;
+    if (tape_tag(node.tape, node.index) != TAPE_STRING) return JSON_ERROR_WRONG_TYPE;
 
-    if (expect(parser, '}'))
-        goto clean_up;
+    size_t length;
+    *out = tape_string_text(node.tape, node.index, &length);
+    return JSON_SUCCESS;
+}
 
-    *out = object_value;
-    return false;
+json_error json_node_string_get_len(json_node node, const char **out, size_t *length)
+{
+    if (!node.tape || !out || !length) return JSON_ERROR_NULL;
+    if (tape_tag(node.tape, node.index) != TAPE_STRING) return JSON_ERROR_WRONG_TYPE;
 
-clean_up:
-    json_free(object_value);
-    return true;
+    *out = tape_string_text(node.tape, node.index, length);
+    return JSON_SUCCESS;
 }
 
-// Determines the JSON type and parse the corresponding entry.
-static bool parse_entry(json_parser *parser, json_value **out)
+json_error json_node_array_length(json_node array, size_t *out)
 {
-    parser->depth++;
-    if (parser->depth > parser->options->max_depth)
-    {
-        report_parsing_error(parser, JSON_ERROR_MAX_DEPTH, "maximum depth (%zu) exceeded", parser->options->max_depth);
-        return true;
-    }
+    if (!array.tape || !out) return JSON_ERROR_NULL;
+    if (tape_tag(array.tape, array.index) != TAPE_ARRAY_START) return JSON_ERROR_WRONG_TYPE;
 
-    bool error = true;
-    if (parser->last_c == '[')
-        error = parse_array(parser, out);
-    else if (parser->last_c == '{')
-        error = parse_object(parser, out);
-    else if (parser->last_c == '"')
-        error = parse_string(parser, out);
-    else if (isalpha(parser->last_c))
-        error = parse_identifier(parser, out);
-    else if (isdigit(parser->last_c) || parser->last_c == '-')
-        error = parse_number(parser, out);
-    else
-        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER, "unexpected character '%c'", parser->last_c);
+    *out = (size_t)tape_payload(array.tape, tape_skip(array.tape, array.index) - 1);
+    return JSON_SUCCESS;
+}
 
-    parser->depth--;
+json_error json_node_array_get(json_node array, size_t index, json_node *out)
+{
+    size_t length;
+    json_error error = json_node_array_length(array, &length);
+    if (error) return error;
+    if (!out) return JSON_ERROR_NULL;
+    if (index >= length) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
 
-    return error;
+    size_t position = array.index + 1;
+    while (index--)
+        position = tape_skip(array.tape, position);
+
+    *out = (json_node) { .tape = array.tape, .index = position, .parent_end = tape_skip(array.tape, array.index) - 1 };
+    return JSON_SUCCESS;
 }
 
-// Main entry point for parsing a JSON input.
-static json_error parse(json_parser *parser, json_value **out)
+json_error json_node_object_size(json_node object, size_t *out)
 {
-    parser->line = 1;
-    parser->column = 0;
-    parser->depth = 0;
-    parser->error = JSON_SUCCESS;
-
-    consume(parser);
-    skip_blank(parser);
+    if (!object.tape || !out) return JSON_ERROR_NULL;
+    if (tape_tag(object.tape, object.index) != TAPE_OBJECT_START) return JSON_ERROR_WRONG_TYPE;
 
-    if (parser->last_c == EOF)
-    {
-        *out = NULL;
-        return JSON_SUCCESS;
-    }
+    *out = (size_t)tape_payload(object.tape, tape_skip(object.tape, object.index) - 1);
+    return JSON_SUCCESS;
+}
 
-    json_value *root = NULL;
-    if (parse_entry(parser, &root))
-        goto clean_up;
+json_error json_node_object_get(json_node object, const char *key, json_node *out)
+{
+    if (!object.tape || !key || !out) return JSON_ERROR_NULL;
+    if (tape_tag(object.tape, object.index) != TAPE_OBJECT_START) return JSON_ERROR_WRONG_TYPE;
 
-    if (parser->last_c != EOF)
+    // Keys carry their length, most of them are told apart without comparing characters.
+    size_t key_length = strlen(key);
+    size_t end = tape_skip(object.tape, object.index) - 1;
+    for (size_t position = object.index + 1; position < end; position = tape_skip(object.tape, position + 1))
     {
-        report_parsing_error(parser, JSON_ERROR_UNEXPECTED_CHARACTER,
-            "expected end of file, found '%c'", parser->last_c);
-        goto clean_up;
+        size_t length;
+        const char *text = tape_string_text(object.tape, position, &length);
+        if (length == key_length && !memcmp(text, key, length))
+        {
+            *out = (json_node) { .tape = object.tape, .index = position + 1, .parent_end = end };
+            return JSON_SUCCESS;
+        }
     }
+    return JSON_ERROR_KEY_NOT_FOUND;
+}
 
-    *out = root;
-    return JSON_SUCCESS;
+json_error json_node_first(json_node container, json_node *out)
+{
+    if (!container.tape || !out) return JSON_ERROR_NULL;
 
-clean_up:
-    if (root)
-        json_free(root);
-    return parser->error;
-}
+    int tag = tape_tag(container.tape, container.index);
+    if (tag != TAPE_ARRAY_START && tag != TAPE_OBJECT_START) return JSON_ERROR_WRONG_TYPE;
 
-// --------------------
-// Input Source Functions
-// --------------------
+    size_t end = tape_skip(container.tape, container.index) - 1;
+    if (container.index + 1 == end) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
 
-static int getc_from_string(json_parser *parser)
-{
-    const char *string = parser->input_string;
-    if (*string == '\0')
-        return EOF;
-    parser->input_string = string + 1;
-    return *string;
+    // The first member of an object starts with its key.
+    size_t position = container.index + (tag == TAPE_OBJECT_START ? 2 : 1);
+    *out = (json_node) { .tape = container.tape, .index = position, .parent_end = end };
+    return JSON_SUCCESS;
 }
 
-json_error json_parse_string(const char *string, json_value **value, const json_parse_options *options)
+json_error json_node_next(json_node node, json_node *out)
 {
-    if (!value) return JSON_ERROR_NULL;
-    if (!options) options = &JSON_DEFAULT_PARSE_OPTIONS;
-
-    json_parser parser = {
-        .input_string = string,
-        .getc = getc_from_string,
-        .options = options
-    };
+    if (!node.tape || !out) return JSON_ERROR_NULL;
+    if (!node.parent_end) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
 
-    if (!string)
-    {
-        report_parsing_error(&parser, JSON_ERROR_NULL, "string is NULL");
-        return JSON_ERROR_NULL;
-    }
+    size_t position = tape_skip(node.tape, node.index);
+    if (position == node.parent_end) return JSON_ERROR_INDEX_OUT_OF_BOUNDS;
 
-    return parse(&parser, value);
+    if (tape_tag(node.tape, node.parent_end) == TAPE_OBJECT_END)
+        position++;
+    *out = (json_node) { .tape = node.tape, .index = position, .parent_end = node.parent_end };
+    return JSON_SUCCESS;
 }
 
-
-static int getc_from_file(json_parser *parser)
+json_error json_node_key(json_node node, const char **out)
 {
-    return fgetc(parser->input_file);
+    if (!node.tape || !out) return JSON_ERROR_NULL;
+    if (!node.parent_end || tape_tag(node.tape, node.parent_end) != TAPE_OBJECT_END) return JSON_ERROR_WRONG_TYPE;
+
+    size_t length;
+    *out = tape_string_text(node.tape, node.index - 1, &length);
+    return JSON_SUCCESS;
 }
 
-json_error json_parse_file(FILE *file, json_value **value, const json_parse_options *options)
+json_error json_node_to_value(json_node node, json_value **out)
 {
-    if (!value) return JSON_ERROR_NULL;
-    if (!options) options = &JSON_DEFAULT_PARSE_OPTIONS;
-    
-    json_parser parser = {
-        .input_file = file,
-        .getc = getc_from_file,
-        .options = options
-    };
-
-    if (!file)
+    if (!node.tape || !out) return JSON_ERROR_NULL;
+
+    json_value scalar;
+    load_tape_scalar(node.tape, node.index, &scalar);
+    if (scalar.type != JSON_ARRAY && scalar.type != JSON_OBJECT)
+        return json_clone(&scalar, out);
+
+    size_t size = (size_t)tape_payload(node.tape, tape_skip(node.tape, node.index) - 1);
+    json_value *container;
+    json_error error = scalar.type == JSON_ARRAY ? json_array_create(&container) : json_object_create(&container);
+    if (error) return error;
+    error = scalar.type == JSON_ARRAY ? json_array_reserve(container, size) : json_object_reserve(container, size);
+
+    json_node child;
+    json_error position_error = json_node_first(node, &child);
+    for (; !error && !position_error; position_error = json_node_next(child, &child))
     {
-        report_parsing_error(&parser, JSON_ERROR_NULL, "file is NULL");
-        return JSON_ERROR_NULL;
+        json_value *value;
+        error = json_node_to_value(child, &value);
+        if (error) break;
+
+        if (scalar.type == JSON_ARRAY)
+            error = json_array_append(container, value);
+        else
+        {
+            // Members are appended like JSON_DUPLICATE_KEYS_KEEP_ALL does, so that lookups
+            // find the first of duplicate keys, as json_node_object_get does.
+            const char *key;
+            json_node_key(child, &key);
+            char *key_copy = strdup(key);
+            if (key_copy)
+            {
+                json_object *object = container->object;
+                object->keys[object->size] = key_copy;
+                object->entry[object->size++] = value;
+            }
+            else
+                error = JSON_ERROR_ALLOCATION;
+        }
+        if (error)
+            json_free(value);
     }
 
-    return parse(&parser, value);
+    if (error)
+    {
+        json_free(container);
+        return error;
+    }
+    if (scalar.type == JSON_OBJECT)
+        rebuild_object_index(container->object);
+    *out = container;
+    return JSON_SUCCESS;
 }
 
 // --------------------
@@ -1378,7 +5777,8 @@ json_error json_parse_file(FILE *file, json_value **value, const json_parse_opti
 const json_format_options JSON_DEFAULT_FORMAT_OPTIONS = {
     .error_info = NULL,
     .indent_size = 2,
-    .max_depth = DEFAULT_MAX_DEPTH
+    .max_depth = DEFAULT_MAX_DEPTH,
+    .unescaped_slashes = false
 };
 
 typedef struct json_serializer {
@@ -1389,15 +5789,63 @@ typedef struct json_serializer {
     {
         FILE *output_file;
         string_builder *output_builder;
+        size_t output_length; // Bytes flushed by serializers only measuring their output
+        struct fd_output *output_fd;
     };
-    void (*putc)(struct json_serializer *serializer, char c);
-    void (*puts)(struct json_serializer *serializer, const char *str);
-    void (*printf)(struct json_serializer *serializer, const char *format, ...);
+
+    // Output is gathered in buffer, and handed to flush along with the data that doesn't fit.
+    char *buffer;
+    size_t used;
+    size_t capacity;
+    void (*flush)(struct json_serializer *serializer, const char *data, size_t length);
+    // Optional, takes long data staying valid until the end of the serialization without copying it.
+    void (*reference)(struct json_serializer *serializer, const char *data, size_t length);
 
     size_t depth;
     json_error error;
 } json_serializer;
 
+// Size of the buffer gathering the output of serializers writing to files.
+#define SERIALIZER_BUFFER_SIZE 4096
+
+// Length from which data is referenced rather than copied by serializers able to.
+#define SERIALIZER_REFERENCE_SIZE 1024
+
+static void serializer_write(json_serializer *serializer, const char *data, size_t length)
+{
+    if (length > serializer->capacity - serializer->used)
+    {
+        serializer->flush(serializer, data, length);
+        return;
+    }
+    memcpy(serializer->buffer + serializer->used, data, length);
+    serializer->used += length;
+}
+
+static void serializer_putc(json_serializer *serializer, char c)
+{
+    if (serializer->used == serializer->capacity)
+    {
+        serializer->flush(serializer, &c, 1);
+        return;
+    }
+    serializer->buffer[serializer->used++] = c;
+}
+
+static void serializer_puts(json_serializer *serializer, const char *str)
+{
+    serializer_write(serializer, str, strlen(str));
+}
+
+// Writes data of the serialized value, which outlives the serialization.
+static void serializer_write_stable(json_serializer *serializer, const char *data, size_t length)
+{
+    if (serializer->reference && length >= SERIALIZER_REFERENCE_SIZE)
+        serializer->reference(serializer, data, length);
+    else
+        serializer_write(serializer, data, length);
+}
+
 static void serialize_value(json_serializer *serializer, const json_value *entry);
 
 static void report_serialization_error(json_serializer *serializer, json_error error_type, const char *error_fmt, ...)
@@ -1424,66 +5872,131 @@ static void report_serialization_error(json_serializer *serializer, json_error e
     va_end(args);
 }
 
-// Writes indentation spaces to the file.
+// Writes a line break and the indentation of the current depth, in runs of spaces.
 static void serialize_indent(json_serializer *serializer)
 {
+    static const char line[] = "\n                                                               ";
+    enum { LINE_SPACES = sizeof(line) - 2 };
+
     size_t indent = serializer->options->indent_size;
     if (indent == 0) return;
 
-    serializer->putc(serializer, '\n');
-    for (indent *= serializer->depth; indent != 0; --indent)
-        serializer->putc(serializer, ' ');
+    indent *= serializer->depth;
+    size_t run = indent < LINE_SPACES ? indent : LINE_SPACES;
+    serializer_write(serializer, line, run + 1);
+    for (indent -= run; indent != 0; indent -= run)
+    {
+        run = indent < LINE_SPACES ? indent : LINE_SPACES;
+        serializer_write(serializer, line + 1, run);
+    }
 }
 
 // Prints a JSON array with proper formatting.
 static void serialize_array(json_serializer *serializer, const json_array *array)
 {
-    serializer->putc(serializer, '[');
+    serializer_putc(serializer, '[');
 
     serializer->depth++;
     const json_array *entry = array;
     for (size_t i = 0; i < array->length; ++i)
     {
-        if (i > 0) serializer->putc(serializer, ',');
+        if (i > 0) serializer_putc(serializer, ',');
         serialize_indent(serializer);
         serialize_value(serializer, entry->entry[i]);
     }
     serializer->depth--;
 
     serialize_indent(serializer);
-    serializer->putc(serializer, ']');
+    serializer_putc(serializer, ']');
 }
 
-// Writes a JSON string escaping special characters.
-static void serialize_escape_string(json_serializer *serializer, char *str)
+// Character following the backslash of the escape sequence of each byte, 'u' standing
+// for \u00XX, or 0 for bytes written as they are.
+static const char ESCAPE_CODES[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    ['"'] = '"', ['/'] = '/', ['\\'] = '\\', [0x7F] = 'u'
+};
+
+// Returns the first byte of [data, end) to escape, or end. Slashes are only escaped
+// when escape_slash is set.
+static const char *find_escape(const char *data, const char *end, bool escape_slash)
 {
-    for (; *str != '\0'; ++str)
+    // Without slashes to escape, quotes are looked for twice instead.
+    char slash = escape_slash ? '/' : '"';
+
+#ifdef SIMD_CHUNK_SIZE
+    while (end - data >= SIMD_CHUNK_SIZE)
     {
-        if ((unsigned char)*str < 0x20 || *str == 0x7F)
-        {
-            serializer->printf(serializer, "\\u00%02X", *str & 0xFF);
-            continue;
-        }
+        simd_chunk chunk = simd_load(data);
+        simd_chunk escaped = simd_or(
+            simd_or(simd_eq(chunk, simd_splat('"')), simd_eq(chunk, simd_splat('\\'))),
+            simd_or(simd_eq(chunk, simd_splat(slash)), simd_eq(chunk, simd_splat(0x7F))));
+        escaped = simd_or(escaped, simd_eq(simd_min(chunk, simd_splat(0x1F)), chunk));
+
+        uint64_t mask = simd_mask(escaped);
+        if (mask)
+            return data + lowest_bit_index(mask);
+        data += SIMD_CHUNK_SIZE;
+    }
+#endif
 
-        switch (*str)
-        {
-        case '"':  serializer->puts(serializer, "\\\""); break;
-        case '\\': serializer->puts(serializer, "\\\\"); break;
-        case '/':  serializer->puts(serializer, "\\/"); break;
-        case '\b': serializer->puts(serializer, "\\b"); break;
-        case '\f': serializer->puts(serializer, "\\f"); break;
-        case '\n': serializer->puts(serializer, "\\n"); break;
-        case '\r': serializer->puts(serializer, "\\r"); break;
-        case '\t': serializer->puts(serializer, "\\t"); break;
-        default:   serializer->putc(serializer, *str); break;
-        }
+    // Test 8 bytes at once for a zero byte after XOR, or a byte below 0x20.
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    const uint64_t high_bits = ones * 0x80;
+    while (end - data >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        uint64_t quote = word ^ (ones * '"');
+        uint64_t backslash = word ^ (ones * '\\');
+        uint64_t other = word ^ (ones * (unsigned char)slash);
+        uint64_t del = word ^ (ones * 0x7F);
+        uint64_t escaped = ((quote - ones) & ~quote)
+            | ((backslash - ones) & ~backslash)
+            | ((other - ones) & ~other)
+            | ((del - ones) & ~del)
+            | ((word - ones * 0x20) & ~word);
+        if (escaped & high_bits)
+            break;
+        data += 8;
+    }
+
+    for (; data != end; ++data)
+    {
+        unsigned char c = (unsigned char)*data;
+        if (ESCAPE_CODES[c] && (c != '/' || escape_slash))
+            break;
+    }
+    return data;
+}
+
+// Writes a JSON string of the given length escaping special characters, the runs of
+// characters in between being written at once.
+static void serialize_escape_string(json_serializer *serializer, const char *str, size_t length)
+{
+    static const char hex_digits[] = "0123456789ABCDEF";
+    bool escape_slash = !serializer->options->unescaped_slashes;
+    const char *end = str + length;
+    for (;;)
+    {
+        const char *escaped = find_escape(str, end, escape_slash);
+        if (escaped != str)
+            serializer_write_stable(serializer, str, escaped - str);
+        if (escaped == end)
+            break;
+
+        unsigned char c = (unsigned char)*escaped;
+        char sequence[6] = { '\\', ESCAPE_CODES[c], '0', '0', hex_digits[c >> 4], hex_digits[c & 0xF] };
+        serializer_write(serializer, sequence, sequence[1] == 'u' ? 6 : 2);
+        str = escaped + 1;
     }
 }
 
 // Prints a JSON object with proper formatting.
 static void serialize_object(json_serializer *serializer, const json_object *object)
 {
-    serializer->putc(serializer, '{');
+    serializer_putc(serializer, '{');
 
     serializer->depth++;
     const json_object *entry = object;
@@ -1491,18 +6004,148 @@ static void serialize_object(json_serializer *serializer, const json_object *obj
 
     for (size_t i = 0; i < object->size; ++i)
     {
-        if (i > 0) serializer->putc(serializer, ',');
+        if (i > 0) serializer_putc(serializer, ',');
         serialize_indent(serializer);
-        serializer->putc(serializer, '"');
-        serialize_escape_string(serializer, entry->keys[i]);
-        serializer->puts(serializer, is_compact ? "\":" : "\": ");
+        serializer_putc(serializer, '"');
+        serialize_escape_string(serializer, entry->keys[i], strlen(entry->keys[i]));
+        serializer_puts(serializer, is_compact ? "\":" : "\": ");
         serialize_value(serializer, entry->entry[i]);
     }
 
     serializer->depth--;
 
     serialize_indent(serializer);
-    serializer->putc(serializer, '}');
+    serializer_putc(serializer, '}');
+}
+
+// Enough for the 20 digits of UINT64_MAX, or a minus sign and 19 digits, and a NUL.
+#define INTEGER_BUFFER_SIZE 21
+
+// Formats an integer in decimal, two digits at a time, at the end of a buffer.
+// Returns the start of the NUL-terminated text.
+static char *format_integer(uint64_t magnitude, bool negative, char *buffer_end)
+{
+    static const char digit_pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    char *text = buffer_end;
+    *--text = '\0';
+    while (magnitude >= 100)
+    {
+        const char *pair = digit_pairs + (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--text = pair[1];
+        *--text = pair[0];
+    }
+    if (magnitude >= 10)
+    {
+        const char *pair = digit_pairs + magnitude * 2;
+        *--text = pair[1];
+        *--text = pair[0];
+    }
+    else
+        *--text = (char)('0' + magnitude);
+
+    if (negative)
+        *--text = '-';
+    return text;
+}
+
+// Enough for a sign, 17 digits, a decimal point and four leading zeros or an exponent, and a NUL.
+#define DOUBLE_BUFFER_SIZE 32
+
+// Formats a finite double with the fewest digits that parse back to it, in fixed notation
+// when its decimal exponent is between -4 and 16, in scientific notation otherwise.
+// Returns the start of the NUL-terminated text, or NULL for infinities and NaNs.
+static char *format_double(double value, char *buffer)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased_exponent = (int)(bits >> 52) & 0x7FF;
+    uint64_t fraction = bits & ((UINT64_C(1) << 52) - 1);
+    if (biased_exponent == 0x7FF) return NULL;
+
+    uint64_t digits;
+    int exponent = 0;
+    if (biased_exponent != 0)
+    {
+        int shift = 1075 - biased_exponent;
+        uint64_t significand = fraction | UINT64_C(1) << 52;
+        // Integers below 2^53 are exact.
+        if (shift > 0 && shift < 53 && (significand >> shift) << shift == significand)
+            digits = significand >> shift;
+        else
+            shortest_decimal(-shift, significand, 0, &digits, &exponent);
+    }
+    else if (fraction >= 3)
+        shortest_decimal(-1074, fraction, 0, &digits, &exponent);
+    else if (fraction != 0)
+        shortest_decimal(-1074, fraction * 10, -1, &digits, &exponent);
+    else
+        digits = 0;
+
+    while (digits >= 10 && digits % 10 == 0)
+    {
+        digits /= 10;
+        exponent++;
+    }
+
+    char digit_buffer[INTEGER_BUFFER_SIZE];
+    const char *digit_text = format_integer(digits, false, digit_buffer + sizeof(digit_buffer));
+    int count = (int)(digit_buffer + sizeof(digit_buffer) - 1 - digit_text);
+    int point = exponent + count; // Position of the decimal point after the first digit.
+
+    char *text = buffer;
+    if (bits >> 63)
+        *text++ = '-';
+    if (point > 0 && point <= 17)
+    {
+        // 1234, 1200, 12.34
+        if (point >= count)
+        {
+            memcpy(text, digit_text, count);
+            memset(text + count, '0', point - count);
+            text += point;
+        }
+        else
+        {
+            memcpy(text, digit_text, point);
+            text[point] = '.';
+            memcpy(text + point + 1, digit_text + point, count - point);
+            text += count + 1;
+        }
+    }
+    else if (point <= 0 && point > -4)
+    {
+        // 0.0012
+        memcpy(text, "0.000", 2 - point);
+        memcpy(text + 2 - point, digit_text, count);
+        text += 2 - point + count;
+    }
+    else
+    {
+        // 1.234e+20, 1e-07
+        *text++ = digit_text[0];
+        if (count > 1)
+        {
+            *text++ = '.';
+            memcpy(text, digit_text + 1, count - 1);
+            text += count - 1;
+        }
+        int decimal_exponent = point - 1;
+        *text++ = 'e';
+        *text++ = decimal_exponent < 0 ? '-' : '+';
+        char exponent_buffer[INTEGER_BUFFER_SIZE];
+        const char *exponent_text = format_integer(decimal_exponent < 0 ? -decimal_exponent : decimal_exponent, false, exponent_buffer + sizeof(exponent_buffer));
+        if (exponent_text[1] == '\0')
+            *text++ = '0';
+        while (*exponent_text)
+            *text++ = *exponent_text++;
+    }
+    *text = '\0';
+    return buffer;
 }
 
 static void serialize_value(json_serializer *serializer, const json_value *entry)
@@ -1511,29 +6154,50 @@ static void serialize_value(json_serializer *serializer, const json_value *entry
 
     if (serializer->depth > serializer->options->max_depth)
     {
-        serializer->puts(serializer, "null");
+        serializer_puts(serializer, "null");
         report_serialization_error(serializer, JSON_ERROR_MAX_DEPTH, "maximum depth exceeded");
         return;
     }
 
+    json_error lazy_error = resolve_content(&entry);
+    if (lazy_error)
+    {
+        serializer_puts(serializer, "null");
+        report_serialization_error(serializer, lazy_error, "invalid deferred %s", entry->type == JSON_ARRAY ? "array" : "object");
+        return;
+    }
+
     switch (entry->type)
     {
     case JSON_NULL:
-        serializer->puts(serializer, "null");
+        serializer_puts(serializer, "null");
         break;
 
     case JSON_NUMBER:
-        serializer->printf(serializer, "%g", entry->number);
+        if (entry->flags & (NUMBER_INT64 | NUMBER_UINT64))
+        {
+            char buffer[INTEGER_BUFFER_SIZE];
+            bool negative = (entry->flags & NUMBER_INT64) && entry->integer < 0;
+            uint64_t magnitude = negative ? 0 - (uint64_t)entry->integer : (uint64_t)entry->integer;
+            serializer_puts(serializer, format_integer(magnitude, negative, buffer + sizeof(buffer)));
+        }
+        else
+        {
+            // Infinities and NaNs have no JSON representation.
+            char buffer[DOUBLE_BUFFER_SIZE];
+            const char *text = format_double(entry->number, buffer);
+            serializer_puts(serializer, text ? text : "null");
+        }
         break;
 
     case JSON_STRING:
-        serializer->putc(serializer, '"');
-        serialize_escape_string(serializer, entry->string);
-        serializer->putc(serializer, '"');
+        serializer_putc(serializer, '"');
+        serialize_escape_string(serializer, string_text(entry), string_length(entry));
+        serializer_putc(serializer, '"');
         break;
 
     case JSON_BOOL:
-        serializer->puts(serializer, entry->boolean ? "true" : "false");
+        serializer_puts(serializer, entry->boolean ? "true" : "false");
         break;
 
     case JSON_ARRAY:
@@ -1546,22 +6210,22 @@ static void serialize_value(json_serializer *serializer, const json_value *entry
     }
 }
 
-static void putc_to_file(json_serializer *serializer, char c)
+// Writes the buffered output and the data that didn't fit to the file.
+static void flush_to_file(json_serializer *serializer, const char *data, size_t length)
 {
-    fputc(c, serializer->output_file);
-}
-
-static void puts_to_file(json_serializer *serializer, const char *str)
-{
-    fputs(str, serializer->output_file);
-}
+    bool failed = serializer->used && fwrite(serializer->buffer, 1, serializer->used, serializer->output_file) != serializer->used;
+    serializer->used = 0;
+    if (length <= serializer->capacity)
+    {
+        if (length)
+            memcpy(serializer->buffer, data, length);
+        serializer->used = length;
+    }
+    else if (fwrite(data, 1, length, serializer->output_file) != length)
+        failed = true;
 
-static void printf_to_file(json_serializer *serializer, const char *format, ...)
-{
-    va_list args;
-    va_start(args, format);
-    vfprintf(serializer->output_file, format, args);
-    va_end(args);
+    if (failed && serializer->error == JSON_SUCCESS)
+        report_serialization_error(serializer, JSON_ERROR_IO, "couldn't write to file");
 }
 
 json_error serialize(json_serializer *serializer, const json_value *entry)
@@ -1570,7 +6234,8 @@ json_error serialize(json_serializer *serializer, const json_value *entry)
     serializer->error = JSON_SUCCESS;
     serialize_value(serializer, entry);
     if (serializer->options->indent_size != 0)
-        serializer->putc(serializer, '\n');
+        serializer_putc(serializer, '\n');
+    serializer->flush(serializer, NULL, 0);
     return serializer->error;
 }
 
@@ -1578,11 +6243,12 @@ json_error json_serialize_to_file(const json_value *entry, FILE *file, const jso
 {
     if (!options) options = &JSON_DEFAULT_FORMAT_OPTIONS;
 
+    char buffer[SERIALIZER_BUFFER_SIZE];
     json_serializer serializer = {
         .options = options,
-        .putc = putc_to_file,
-        .puts = puts_to_file,
-        .printf = printf_to_file,
+        .buffer = buffer,
+        .capacity = sizeof(buffer),
+        .flush = flush_to_file,
         .output_file = file
     };
 
@@ -1595,22 +6261,18 @@ json_error json_serialize_to_file(const json_value *entry, FILE *file, const jso
     return serialize(&serializer, entry);
 }
 
-static void putc_to_string(json_serializer *serializer, char c)
+// Serializers writing to strings use the storage of the builder as their buffer,
+// which grows to take the data that doesn't fit.
+static void flush_to_string(json_serializer *serializer, const char *data, size_t length)
 {
-    string_builder_append(serializer->output_builder, c);
-}
-
-static void puts_to_string(json_serializer *serializer, const char *str)
-{
-    string_builder_append_string(serializer->output_builder, str);
-}
-
-static void printf_to_string(json_serializer *serializer, const char *format, ...)
-{
-    va_list args;
-    va_start(args, format);
-    string_builder_append_format(serializer->output_builder, format, args);
-    va_end(args);
+    string_builder *builder = serializer->output_builder;
+    builder->size = serializer->used;
+    if (length && string_builder_append_bytes(builder, data, length) && serializer->error == JSON_SUCCESS)
+        report_serialization_error(serializer, JSON_ERROR_ALLOCATION, "couldn't reallocate string buffer");
+
+    serializer->buffer = builder->data;
+    serializer->used = builder->size;
+    serializer->capacity = builder->allocated_size ? builder->allocated_size - 1 : 0;
 }
 
 json_error json_serialize_to_string(const json_value *entry, char **dst, const json_format_options *options)
@@ -1621,11 +6283,15 @@ json_error json_serialize_to_string(const json_value *entry, char **dst, const j
     string_builder builder = {0};
     json_serializer serializer = {
         .options = options,
-        .putc = putc_to_string,
-        .puts = puts_to_string,
-        .printf = printf_to_string,
+        .flush = flush_to_string,
         .output_builder = &builder
     };
+    if (string_builder_ensure_capacity(&builder, INITIAL_STRING_BUFFER_SIZE))
+    {
+        report_serialization_error(&serializer, JSON_ERROR_ALLOCATION, "couldn't allocate string buffer");
+        return JSON_ERROR_ALLOCATION;
+    }
+    flush_to_string(&serializer, NULL, 0);
 
     if (serialize(&serializer, entry) != JSON_SUCCESS)
         goto clean_up;
@@ -1641,3 +6307,185 @@ clean_up:
     string_builder_free(&builder);
     return serializer.error;
 }
+
+// Serializers measuring their output count the bytes they are handed, and reuse their buffer.
+static void flush_to_counter(json_serializer *serializer, const char *data, size_t length)
+{
+    (void)data;
+    serializer->output_length += serializer->used + length;
+    serializer->used = 0;
+}
+
+json_error json_serialized_size(const json_value *entry, const json_format_options *options, size_t *size)
+{
+    if (!size) return JSON_ERROR_NULL;
+    if (!options) options = &JSON_DEFAULT_FORMAT_OPTIONS;
+
+    char buffer[SERIALIZER_BUFFER_SIZE];
+    json_serializer serializer = {
+        .options = options,
+        .buffer = buffer,
+        .capacity = sizeof(buffer),
+        .flush = flush_to_counter,
+        .output_length = 0
+    };
+    json_error error = serialize(&serializer, entry);
+    if (error == JSON_SUCCESS)
+        *size = serializer.output_length;
+    return error;
+}
+
+// Serializers writing to caller buffers write straight into them. The data that doesn't
+// fit is only counted, along with everything after it, to report the length needed.
+static void flush_to_buffer(json_serializer *serializer, const char *data, size_t length)
+{
+    (void)data;
+    if (length == 0) return;
+
+    serializer->output_length += length;
+    serializer->capacity = serializer->used;
+    if (serializer->error == JSON_SUCCESS)
+        report_serialization_error(serializer, JSON_ERROR_BUFFER_TOO_SMALL, "output doesn't fit in buffer");
+}
+
+json_error json_serialize_to_buffer(const json_value *entry, char *buffer, size_t capacity, size_t *length, const json_format_options *options)
+{
+    if (!buffer) return JSON_ERROR_NULL;
+    if (!options) options = &JSON_DEFAULT_FORMAT_OPTIONS;
+
+    // Without room for the null character, nothing is written, even for an empty output.
+    if (!capacity)
+    {
+        size_t size;
+        json_error error = json_serialized_size(entry, options, &size);
+        if (error) return error;
+        if (length)
+            *length = size;
+        return JSON_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    // One byte is kept for the null character.
+    json_serializer serializer = {
+        .options = options,
+        .buffer = buffer,
+        .capacity = capacity - 1,
+        .flush = flush_to_buffer,
+        .output_length = 0
+    };
+    json_error error = serialize(&serializer, entry);
+    if (error == JSON_SUCCESS)
+        buffer[serializer.used] = '\0';
+    if (length && (error == JSON_SUCCESS || error == JSON_ERROR_BUFFER_TOO_SMALL))
+        *length = serializer.used + serializer.output_length;
+    return error;
+}
+
+#ifdef JSON_HAS_WRITEV
+
+// Number of pieces of output gathered before writing them at once.
+#if defined(IOV_MAX) && IOV_MAX < 64
+#define SERIALIZER_IOVEC_COUNT IOV_MAX
+#else
+#define SERIALIZER_IOVEC_COUNT 64
+#endif
+
+// Serializers writing to file descriptors gather the output as a list of pieces, which
+// are either parts of their buffer or long strings of the value, and write it with writev.
+typedef struct fd_output {
+    int fd;
+    struct iovec pieces[SERIALIZER_IOVEC_COUNT];
+    int count;
+    size_t piece_start; // Start of the part of the buffer not yet in the list
+} fd_output;
+
+static void fd_output_add(fd_output *output, const char *data, size_t length)
+{
+    if (length == 0) return;
+    output->pieces[output->count].iov_base = (void*)(uintptr_t)data;
+    output->pieces[output->count].iov_len = length;
+    output->count++;
+}
+
+// Writes the gathered pieces, resuming after partial writes, and empties the buffer.
+static void fd_output_write(json_serializer *serializer)
+{
+    fd_output *output = serializer->output_fd;
+    fd_output_add(output, serializer->buffer + output->piece_start, serializer->used - output->piece_start);
+
+    struct iovec *piece = output->pieces;
+    struct iovec *end = output->pieces + output->count;
+    while (piece != end && serializer->error == JSON_SUCCESS)
+    {
+        ssize_t written = writev(output->fd, piece, (int)(end - piece));
+        if (written < 0)
+        {
+            if (errno != EINTR)
+                report_serialization_error(serializer, JSON_ERROR_IO, "couldn't write to file descriptor");
+            continue;
+        }
+
+        size_t left = (size_t)written;
+        while (piece != end && left >= piece->iov_len)
+            left -= piece++->iov_len;
+        if (left)
+        {
+            piece->iov_base = (char*)piece->iov_base + left;
+            piece->iov_len -= left;
+        }
+    }
+
+    output->count = 0;
+    output->piece_start = 0;
+    serializer->used = 0;
+}
+
+// Ends the current part of the buffer, and adds the data after it.
+static void reference_in_fd(json_serializer *serializer, const char *data, size_t length)
+{
+    // Room is kept for the part of the buffer that fd_output_write adds last.
+    fd_output *output = serializer->output_fd;
+    if (output->count + 3 > SERIALIZER_IOVEC_COUNT)
+        fd_output_write(serializer);
+    fd_output_add(output, serializer->buffer + output->piece_start, serializer->used - output->piece_start);
+    output->piece_start = serializer->used;
+    fd_output_add(output, data, length);
+}
+
+// The data handed to flushes is written along with the list, so it needn't outlive them.
+static void flush_to_fd(json_serializer *serializer, const char *data, size_t length)
+{
+    reference_in_fd(serializer, data, length);
+    fd_output_write(serializer);
+}
+
+#endif
+
+json_error json_serialize_to_fd(const json_value *entry, int fd, const json_format_options *options)
+{
+    if (!options) options = &JSON_DEFAULT_FORMAT_OPTIONS;
+
+#ifdef JSON_HAS_WRITEV
+    char buffer[SERIALIZER_BUFFER_SIZE];
+    fd_output output = { .fd = fd };
+    json_serializer serializer = {
+        .options = options,
+        .buffer = buffer,
+        .capacity = sizeof(buffer),
+        .flush = flush_to_fd,
+        .reference = reference_in_fd,
+        .output_fd = &output
+    };
+
+    if (fd < 0)
+    {
+        report_serialization_error(&serializer, JSON_ERROR_IO, "invalid file descriptor");
+        return JSON_ERROR_IO;
+    }
+
+    return serialize(&serializer, entry);
+#else
+    (void)entry;
+    (void)fd;
+    return JSON_ERROR_IO;
+#endif
+}
@@ -20,6 +20,7 @@ extern "C" {
 #include <stdio.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * @enum json_type
@@ -54,7 +55,10 @@ typedef enum json_error {
     JSON_ERROR_BUFFER_TOO_SMALL,   /**< Buffer too small */
     JSON_ERROR_CIRCULAR_REFERENCE, /**< Circular reference error */
     JSON_ERROR_UNEXPECTED_CHARACTER, /**< Unexpected character error */
-    JSON_ERROR_UNEXPECTED_IDENTIFIER  /**< Unexpected identifier error */
+    JSON_ERROR_UNEXPECTED_IDENTIFIER, /**< Unexpected identifier error */
+    JSON_ERROR_OUT_OF_RANGE,       /**< Number not representable in the requested type */
+    JSON_ERROR_DUPLICATE_KEY,      /**< Duplicate object key */
+    JSON_ERROR_READ_ONLY           /**< Value shared with clones, which can't be modified */
 } json_error;
 
 /**
@@ -63,6 +67,34 @@ typedef enum json_error {
  */
 typedef struct json_value json_value;
 
+/**
+ * @struct json_document
+ * @brief Arena owning the JSON values parsed into it.
+ */
+typedef struct json_document json_document;
+
+/**
+ * @struct json_tape
+ * @brief Read-only document storing parsed values as a flat sequence of tagged words.
+ */
+typedef struct json_tape json_tape;
+
+/**
+ * @struct json_node
+ * @brief Handle on a value stored in a tape, valid as long as the tape.
+ */
+typedef struct json_node {
+    const json_tape *tape; /**< Tape holding the value */
+    size_t index;          /**< Position of the value in the tape */
+    size_t parent_end;     /**< Position of the end of the array or object holding the value (0 for the root) */
+} json_node;
+
+/**
+ * @struct json_key_pool
+ * @brief Table of interned object keys, shared by any number of values and documents.
+ */
+typedef struct json_key_pool json_key_pool;
+
 /**
  * @struct json_error_info
  * @brief Detailed information about JSON errors.
@@ -74,6 +106,17 @@ typedef struct json_error_info {
     char message[256];       /**< Error message */
 } json_error_info;
 
+/**
+ * @enum json_duplicate_keys
+ * @brief How parsing handles members of an object sharing the same key.
+ */
+typedef enum json_duplicate_keys {
+    JSON_DUPLICATE_KEYS_LAST_WINS,  /**< Keep the value of the last member (default) */
+    JSON_DUPLICATE_KEYS_FIRST_WINS, /**< Keep the value of the first member */
+    JSON_DUPLICATE_KEYS_ERROR,      /**< Fail with JSON_ERROR_DUPLICATE_KEY */
+    JSON_DUPLICATE_KEYS_KEEP_ALL    /**< Keep every member without checking (lookups find the first one) */
+} json_duplicate_keys;
+
 /**
  * @struct json_parse_options
  * @brief Options for parsing JSON.
@@ -81,6 +124,15 @@ typedef struct json_error_info {
 typedef struct json_parse_options {
     json_error_info *error_info; /**< Optional pointer to error info for detailed errors (not allocated by the parser, has to be provided or NULL) */
     size_t max_depth;            /**< Maximum allowed nesting depth (default is 1000) */
+    size_t read_buffer_size;     /**< Size of the blocks read by json_parse_file (0 for the default of 64 KiB) */
+    json_document *document;     /**< Optional document owning the parsed values (NULL to allocate each value individually) */
+    bool structural_index;       /**< Index the structure of in-memory inputs in a first pass, then build values from the index (faster on large inputs, ignored by json_parse_file) */
+    json_duplicate_keys duplicate_keys; /**< How objects with duplicate keys are parsed (default keeps the last value) */
+    json_key_pool *key_pool;     /**< Optional pool interning the keys of parsed objects (the pool must outlive the values) */
+    bool freeze_objects;         /**< Freeze parsed objects (see json_object_freeze) */
+    bool lazy;                   /**< Only parse the root of in-memory inputs, arrays and objects nested in it being parsed when first accessed (the input must outlive the values, takes precedence over structural_index, ignored by json_parse_file and json_parse_path).
+                                      Only the nesting of brackets is checked up front, other syntax errors in nested containers are returned by the first access to them, without filling error_info, which is only used during the call (see json_parse_deferred to locate them).
+                                      Since accesses parse and modify the values, lazily parsed values can't be read from several threads at once. */
 } json_parse_options;
 
 /**
@@ -91,6 +143,7 @@ typedef struct json_format_options {
     json_error_info *error_info; /**< Optional pointer to error info for detailed errors */
     size_t indent_size;          /**< Number of spaces for indentation (compact if 0, default is 2) */
     size_t max_depth;            /**< Maximum allowed nesting depth (default is 1000) */
+    bool unescaped_slashes;      /**< Write '/' as it is instead of escaping it as "\/" (default escapes it) */
 } json_format_options;
 
 /**
@@ -116,6 +169,22 @@ json_error json_bool_create(bool value, json_value **out);
  */
 json_error json_number_create(double value, json_value **out);
 
+/**
+ * @brief Creates a JSON number value stored as a 64-bit integer.
+ * @param value Integer value.
+ * @param[out] out Pointer to store the created JSON value.
+ * @return json_error Status code.
+ */
+json_error json_integer_create(int64_t value, json_value **out);
+
+/**
+ * @brief Creates a JSON number value stored as an unsigned 64-bit integer.
+ * @param value Unsigned integer value.
+ * @param[out] out Pointer to store the created JSON value.
+ * @return json_error Status code.
+ */
+json_error json_unsigned_create(uint64_t value, json_value **out);
+
 /**
  * @brief Creates a JSON string value by copying the provided string.
  * @param value C-string value.
@@ -124,6 +193,15 @@ json_error json_number_create(double value, json_value **out);
  */
 json_error json_string_create(const char *value, json_value **out);
 
+/**
+ * @brief Creates a JSON string value by copying a string of the given length, which may contain null characters.
+ * @param value String value.
+ * @param length Length of the string in bytes.
+ * @param[out] out Pointer to store the created JSON value.
+ * @return json_error Status code.
+ */
+json_error json_string_create_len(const char *value, size_t length, json_value **out);
+
 /**
  * @brief Creates a JSON string value without copying the provided string.
  * @param value C-string value, which becomes owned by the json_entry.
@@ -147,7 +225,16 @@ json_error json_array_create(json_value **out);
 json_error json_object_create(json_value **out);
 
 /**
- * @brief Creates a deep copy of a JSON value.
+ * @brief Creates a copy of a JSON value sharing its arrays and objects with copy-on-write.
+ *
+ * The source is left as it is and can still be modified through any of its values. The first
+ * clone of an array or object copies it once into a read-only tree, which the clones of the clone,
+ * and of the values read from it, then share in constant time. The values of a clone are read
+ * without copying anything, and modifying them directly fails with JSON_ERROR_READ_ONLY: a clone
+ * only gets its own array or object when it is modified, or when a member is taken with
+ * json_array_get_mutable or json_object_get_mutable, its arrays and objects staying shared, so
+ * only the containers on the path to a change are copied. Containers parsed lazily are parsed
+ * in the copy, which doesn't depend on the document or buffer of the source.
  * @param entry JSON value to clone.
  * @param[out] out Pointer to store the cloned JSON value.
  * @return json_error Status code.
@@ -178,12 +265,33 @@ json_error json_bool_get(const json_value *value, bool *out);
 
 /**
  * @brief Gets the numeric value from a JSON number entry.
+ *
+ * Numbers stored as integers are converted to the nearest double.
  * @param entry JSON value.
  * @param[out] out Pointer to store the number.
  * @return json_error Status code.
  */
 json_error json_number_get(const json_value *value, double *out);
 
+/**
+ * @brief Gets the value of a JSON number entry as a 64-bit integer.
+ *
+ * Parsed numbers without fraction or exponent are stored as integers and are
+ * returned exactly. Other numbers must have an integral value.
+ * @param entry JSON value.
+ * @param[out] out Pointer to store the integer.
+ * @return json_error Status code (JSON_ERROR_OUT_OF_RANGE if the number isn't an int64_t).
+ */
+json_error json_integer_get(const json_value *value, int64_t *out);
+
+/**
+ * @brief Gets the value of a JSON number entry as an unsigned 64-bit integer.
+ * @param entry JSON value.
+ * @param[out] out Pointer to store the unsigned integer.
+ * @return json_error Status code (JSON_ERROR_OUT_OF_RANGE if the number isn't a uint64_t).
+ */
+json_error json_unsigned_get(const json_value *value, uint64_t *out);
+
 /**
  * @brief Gets the string from a JSON string entry.
  * @param entry JSON value.
@@ -192,6 +300,15 @@ json_error json_number_get(const json_value *value, double *out);
  */
 json_error json_string_get(const json_value *value, const char **out);
 
+/**
+ * @brief Gets the string from a JSON string entry, and its length (which counts the null characters it may contain).
+ * @param entry JSON value.
+ * @param[out] out Pointer to store the string, null-terminated.
+ * @param[out] length Pointer to store the length of the string in bytes.
+ * @return json_error Status code.
+ */
+json_error json_string_get_len(const json_value *value, const char **out, size_t *length);
+
 /**
  * @brief Changes a JSON value to null.
  * @param entry JSON value to change.
@@ -215,6 +332,22 @@ json_error json_set_as_bool(json_value *value, bool new_value);
  */
 json_error json_set_as_number(json_value *value, double new_value);
 
+/**
+ * @brief Changes a JSON value to a number stored as a 64-bit integer.
+ * @param entry JSON value to change.
+ * @param value New integer value.
+ * @return json_error Status code.
+ */
+json_error json_set_as_integer(json_value *value, int64_t new_value);
+
+/**
+ * @brief Changes a JSON value to a number stored as an unsigned 64-bit integer.
+ * @param entry JSON value to change.
+ * @param value New unsigned integer value.
+ * @return json_error Status code.
+ */
+json_error json_set_as_unsigned(json_value *value, uint64_t new_value);
+
 /**
  * @brief Changes a JSON value to a string (by copying).
  * @param entry JSON value to change.
@@ -223,6 +356,15 @@ json_error json_set_as_number(json_value *value, double new_value);
  */
 json_error json_set_as_string(json_value *value, const char *new_value);
 
+/**
+ * @brief Changes a JSON value to a string of the given length (by copying), which may contain null characters.
+ * @param entry JSON value to change.
+ * @param string New string.
+ * @param length Length of the string in bytes.
+ * @return json_error Status code.
+ */
+json_error json_set_as_string_len(json_value *value, const char *new_value, size_t length);
+
 /**
  * @brief Changes a JSON value to a string without copying.
  * @param entry JSON value to change.
@@ -262,6 +404,18 @@ json_error json_array_length(const json_value *array, size_t *out);
  */
 json_error json_array_get(const json_value *array, size_t index, json_value **out);
 
+/**
+ * @brief Gets an element of a JSON array to modify it.
+ *
+ * Same as json_array_get, but an array sharing its elements with clones first gets its
+ * own copy of them (see json_clone).
+ * @param array JSON array value.
+ * @param index Zero-based index of the element.
+ * @param[out] out Pointer to store the JSON element.
+ * @return json_error Status code.
+ */
+json_error json_array_get_mutable(json_value *array, size_t index, json_value **out);
+
 /**
  * @brief Sets an element in a JSON array.
  * @param array JSON array value.
@@ -298,6 +452,21 @@ json_error json_array_insert(json_value *array, size_t index, json_value *value)
  */
 json_error json_array_remove(json_value *array, size_t index, json_value **out);
 
+/**
+ * @brief Reserves room in a JSON array, so that it can grow to a capacity without reallocating.
+ * @param array JSON array value.
+ * @param capacity Number of values the array can hold.
+ * @return json_error Status code.
+ */
+json_error json_array_reserve(json_value *array, size_t capacity);
+
+/**
+ * @brief Releases the room a JSON array has beyond its current length.
+ * @param array JSON array value.
+ * @return json_error Status code.
+ */
+json_error json_array_shrink_to_fit(json_value *array);
+
 /**
  * @brief Returns the number of key-value pairs in a JSON object.
  * @param object JSON object value.
@@ -324,6 +493,18 @@ json_error json_object_has_key(const json_value *object, const char *key, bool *
  */
 json_error json_object_get(const json_value *object, const char *key, json_value **out);
 
+/**
+ * @brief Gets a value of a JSON object by key to modify it.
+ *
+ * Same as json_object_get, but an object sharing its values with clones first gets its
+ * own copy of them (see json_clone).
+ * @param object JSON object value.
+ * @param key Key to search for.
+ * @param[out] out Pointer to store the JSON value.
+ * @return json_error Status code.
+ */
+json_error json_object_get_mutable(json_value *object, const char *key, json_value **out);
+
 /**
  * @brief Sets a key-value pair in a JSON object.
  * @param object JSON object value.
@@ -343,6 +524,113 @@ json_error json_object_set(json_value *object, const char *key, json_value *valu
  */
 json_error json_object_remove(json_value *object, const char *key, json_value **out);
 
+/**
+ * @brief Freezes a JSON object, sorting its keys so that lookups search them by bisection.
+ *
+ * Wide objects are otherwise looked up through a hash index, which a frozen object does
+ * without. Members keep their order, and removing members keeps the object frozen,
+ * adding members thaws it. Objects too small to be indexed are left as they are.
+ * @param object JSON object value.
+ * @return json_error Status code.
+ */
+json_error json_object_freeze(json_value *object);
+
+/**
+ * @brief Reserves room in a JSON object, so that it can grow to a capacity without reallocating.
+ * @param object JSON object value.
+ * @param capacity Number of members the object can hold.
+ * @return json_error Status code.
+ */
+json_error json_object_reserve(json_value *object, size_t capacity);
+
+/**
+ * @brief Releases the room a JSON object has beyond its current size.
+ * @param object JSON object value.
+ * @return json_error Status code.
+ */
+json_error json_object_shrink_to_fit(json_value *object);
+
+/**
+ * @brief Creates an empty document, to parse values into (see json_parse_options).
+ *
+ * Values parsed into a document are allocated from an arena owned by the document,
+ * and are all released at once by json_document_free (json_free isn't needed on them).
+ * They can still be modified: memory needed by the modifications is allocated
+ * individually, and is released by calling json_free on the root before freeing the document.
+ * @param[out] out Pointer to store the created document.
+ * @return json_error Status code.
+ */
+json_error json_document_create(json_document **out);
+
+/**
+ * @brief Frees a document and all the values parsed into it.
+ * @param document Document to free.
+ */
+void json_document_free(json_document *document);
+
+/**
+ * @brief Sets how much memory the calling thread keeps for reuse when values are freed.
+ *
+ * Values and the storage of small arrays and objects freed by the thread are kept in free
+ * lists by size, and reused by the next allocations of the same size rather than returned
+ * to malloc. The pool is disabled by default (a limit of 0). Lowering the limit frees what
+ * exceeds it: set it back to 0 before the thread exits to free everything it kept.
+ * @param bytes Maximum number of bytes kept by the calling thread.
+ */
+void json_node_pool_set_limit(size_t bytes);
+
+/**
+ * @brief Creates an empty key pool, to intern object keys into (see json_key_intern).
+ *
+ * Interned keys are stored once, for as long as the pool lives, and each distinct key
+ * has a single canonical pointer. Interning may be called from several threads at once.
+ * @param[out] out Pointer to store the created pool.
+ * @return json_error Status code.
+ */
+json_error json_key_pool_create(json_key_pool **out);
+
+/**
+ * @brief Frees a key pool and all the keys interned into it.
+ *
+ * Values whose keys were interned into the pool must be freed first.
+ * @param pool Key pool to free.
+ */
+void json_key_pool_free(json_key_pool *pool);
+
+/**
+ * @brief Interns a key, giving its canonical pointer in the pool.
+ * @param pool Key pool.
+ * @param key Key to intern.
+ * @param[out] out Pointer to store the interned key.
+ * @return json_error Status code.
+ */
+json_error json_key_intern(json_key_pool *pool, const char *key, const char **out);
+
+/**
+ * @brief Gets a value from a JSON object by an interned key.
+ *
+ * Same as json_object_get, but objects whose keys were interned into the same pool
+ * are searched by comparing pointers.
+ * @param object JSON object value.
+ * @param key Key given by json_key_intern.
+ * @param[out] out Pointer to store the value.
+ * @return json_error Status code.
+ */
+json_error json_object_get_interned(const json_value *object, const char *key, json_value **out);
+
+/**
+ * @brief Sets a value in a JSON object by an interned key.
+ *
+ * Same as json_object_set, but the object refers to the interned key instead of copying
+ * it when it doesn't own copies of its other keys either, as objects that are empty or
+ * were parsed with a key pool (the pool must outlive the object).
+ * @param object JSON object value.
+ * @param key Key given by json_key_intern.
+ * @param value JSON value to set (ownership transferred).
+ * @return json_error Status code.
+ */
+json_error json_object_set_interned(json_value *object, const char *key, json_value *value);
+
 /**
  * @brief Parses a JSON string.
  * @param string C-string containing the JSON input.
@@ -352,6 +640,32 @@ json_error json_object_remove(json_value *object, const char *key, json_value **
  */
 json_error json_parse_string(const char *string, json_value **value, const json_parse_options *options);
 
+/**
+ * @brief Parses a JSON buffer of known length (does not need to be NUL-terminated).
+ * @param buffer Buffer containing the JSON input.
+ * @param length Number of bytes in the buffer.
+ * @param[out] value Pointer to store the parsed JSON value.
+ * @param options Optional parsing options (NULL for default values).
+ * @return json_error Status code.
+ */
+json_error json_parse_buffer(const char *buffer, size_t length, json_value **value, const json_parse_options *options);
+
+/**
+ * @brief Parses a mutable JSON buffer in situ, without copying strings.
+ *
+ * Strings and object keys are unescaped inside the buffer and the parsed values
+ * point to them, so the buffer is overwritten and must stay alive and unmodified
+ * as long as the parsed values are used. Values can still be modified and freed
+ * as usual.
+ *
+ * @param buffer Buffer containing the JSON input, modified by the parser.
+ * @param length Number of bytes in the buffer.
+ * @param[out] value Pointer to store the parsed JSON value.
+ * @param options Optional parsing options (NULL for default values).
+ * @return json_error Status code.
+ */
+json_error json_parse_insitu(char *buffer, size_t length, json_value **value, const json_parse_options *options);
+
 /**
  * @brief Parses JSON input from a file.
  * @param file File pointer containing the JSON input.
@@ -361,6 +675,185 @@ json_error json_parse_string(const char *string, json_value **value, const json_
  */
 json_error json_parse_file(FILE *file, json_value **value, const json_parse_options *options);
 
+/**
+ * @brief Parses JSON input from a file path.
+ *
+ * Regular files are memory-mapped and parsed in place where the platform supports it,
+ * other files are read like json_parse_file.
+ * @param path Path of the file containing the JSON input.
+ * @param[out] value Pointer to store the parsed JSON value.
+ * @param options Optional parsing options (NULL for default values).
+ * @return json_error Status code.
+ */
+json_error json_parse_path(const char *path, json_value **value, const json_parse_options *options);
+
+/**
+ * @brief Parses the array or object of a lazily parsed container if it is still deferred.
+ *
+ * Accessing a deferred container parses it too, but only returns the error code: this
+ * also locates syntax errors in the input, which must still be alive. The arrays and
+ * objects it holds stay deferred. Values that aren't deferred are left as they are.
+ * @param value Value parsed with the lazy option, or one of the values it holds.
+ * @param error_info Optional pointer to store the location of an error (NULL to ignore).
+ * @return json_error Status code.
+ */
+json_error json_parse_deferred(json_value *value, json_error_info *error_info);
+
+/**
+ * @brief Parses JSON input from a buffer into a read-only tape.
+ *
+ * Instead of a tree of values, the tape stores the parsed values one after the other in
+ * a single array, and their strings in a single buffer. Values are read through json_node
+ * handles, and are all released at once by json_tape_free. Objects keep every member
+ * (lookups find the first one, as with JSON_DUPLICATE_KEYS_KEEP_ALL). Only the max_depth
+ * and error_info options are used.
+ * @param buffer Buffer containing the JSON input (doesn't have to be null-terminated).
+ * @param length Length of the input in bytes.
+ * @param[out] out Pointer to store the parsed tape (NULL for an empty input).
+ * @param options Optional parsing options (NULL for default values).
+ * @return json_error Status code.
+ */
+json_error json_parse_tape(const char *buffer, size_t length, json_tape **out, const json_parse_options *options);
+
+/**
+ * @brief Frees a tape and all the values parsed into it.
+ * @param tape Tape to free.
+ */
+void json_tape_free(json_tape *tape);
+
+/**
+ * @brief Gets the root value of a tape.
+ * @param tape Parsed tape.
+ * @param[out] out Pointer to store the node of the root value.
+ * @return json_error Status code.
+ */
+json_error json_tape_root(const json_tape *tape, json_node *out);
+
+/**
+ * @brief Gets the type of a tape value.
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the type.
+ * @return json_error Status code.
+ */
+json_error json_node_get_type(json_node node, json_type *out);
+
+/**
+ * @brief Gets the boolean of a tape value (see json_bool_get).
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the boolean.
+ * @return json_error Status code.
+ */
+json_error json_node_bool_get(json_node node, bool *out);
+
+/**
+ * @brief Gets the number of a tape value as a double (see json_number_get).
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the number.
+ * @return json_error Status code.
+ */
+json_error json_node_number_get(json_node node, double *out);
+
+/**
+ * @brief Gets the number of a tape value as a signed integer (see json_integer_get).
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the integer.
+ * @return json_error Status code.
+ */
+json_error json_node_integer_get(json_node node, int64_t *out);
+
+/**
+ * @brief Gets the number of a tape value as an unsigned integer (see json_unsigned_get).
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the integer.
+ * @return json_error Status code.
+ */
+json_error json_node_unsigned_get(json_node node, uint64_t *out);
+
+/**
+ * @brief Gets the string of a tape value.
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the string, owned by the tape.
+ * @return json_error Status code.
+ */
+json_error json_node_string_get(json_node node, const char **out);
+
+/**
+ * @brief Gets the string of a tape value, and its length (see json_string_get_len).
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the string, owned by the tape.
+ * @param[out] length Pointer to store the length of the string in bytes.
+ * @return json_error Status code.
+ */
+json_error json_node_string_get_len(json_node node, const char **out, size_t *length);
+
+/**
+ * @brief Gets the length of a tape array.
+ * @param array Node of the array.
+ * @param[out] out Pointer to store the length.
+ * @return json_error Status code.
+ */
+json_error json_node_array_length(json_node array, size_t *out);
+
+/**
+ * @brief Gets a value from a tape array by index, skipping over the values before it.
+ * @param array Node of the array.
+ * @param index Index of the value.
+ * @param[out] out Pointer to store the node of the value.
+ * @return json_error Status code.
+ */
+json_error json_node_array_get(json_node array, size_t index, json_node *out);
+
+/**
+ * @brief Gets the number of members of a tape object.
+ * @param object Node of the object.
+ * @param[out] out Pointer to store the size.
+ * @return json_error Status code.
+ */
+json_error json_node_object_size(json_node object, size_t *out);
+
+/**
+ * @brief Gets a value from a tape object by key.
+ * @param object Node of the object.
+ * @param key Key to look up.
+ * @param[out] out Pointer to store the node of the value.
+ * @return json_error Status code.
+ */
+json_error json_node_object_get(json_node object, const char *key, json_node *out);
+
+/**
+ * @brief Gets the first value of a tape array, or the value of the first member of a tape object.
+ *
+ * Together with json_node_next, iterates over a container in a single pass.
+ * @param container Node of the array or object.
+ * @param[out] out Pointer to store the node of the value.
+ * @return json_error Status code (JSON_ERROR_INDEX_OUT_OF_BOUNDS if the container is empty).
+ */
+json_error json_node_first(json_node container, json_node *out);
+
+/**
+ * @brief Gets the value following another in the same tape array or object.
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the node of the next value.
+ * @return json_error Status code (JSON_ERROR_INDEX_OUT_OF_BOUNDS after the last value).
+ */
+json_error json_node_next(json_node node, json_node *out);
+
+/**
+ * @brief Gets the key of a tape object member.
+ * @param node Node of the member value.
+ * @param[out] out Pointer to store the key, owned by the tape.
+ * @return json_error Status code (JSON_ERROR_WRONG_TYPE if the value isn't in an object).
+ */
+json_error json_node_key(json_node node, const char **out);
+
+/**
+ * @brief Copies a tape value into a new JSON value, which can be modified.
+ * @param node Node of the value.
+ * @param[out] out Pointer to store the created value.
+ * @return json_error Status code.
+ */
+json_error json_node_to_value(json_node node, json_value **out);
+
 /**
  * @brief Serializes a JSON value to a file.
  * @param entry JSON value to serialize.
@@ -379,6 +872,39 @@ json_error json_serialize_to_file(const json_value *value, FILE *file, const jso
  */
 json_error json_serialize_to_string(const json_value *value, char **dst, const json_format_options *options);
 
+/**
+ * @brief Computes the length of the serialization of a JSON value, without writing it.
+ * @param value JSON value to measure.
+ * @param options Optional formatting options (NULL for default values).
+ * @param[out] size Pointer to store the length in bytes, not counting a terminating null character.
+ * @return json_error Status code.
+ */
+json_error json_serialized_size(const json_value *value, const json_format_options *options, size_t *size);
+
+/**
+ * @brief Serializes a JSON value into a buffer provided by the caller, followed by a null character.
+ * @param value JSON value to serialize.
+ * @param buffer Buffer receiving the JSON output.
+ * @param capacity Size of the buffer in bytes, which has to be larger than the length of the output.
+ * @param[out] length Optional pointer to store the length of the output, or the length the buffer would need (without the null character) when it is too small.
+ * @param options Optional formatting options (NULL for default values).
+ * @return json_error Status code (JSON_ERROR_BUFFER_TOO_SMALL if the output doesn't fit).
+ */
+json_error json_serialize_to_buffer(const json_value *value, char *buffer, size_t capacity, size_t *length, const json_format_options *options);
+
+/**
+ * @brief Serializes a JSON value to a file descriptor, such as a socket or a pipe.
+ *
+ * The output is written with writev, long strings of the value being written from where
+ * they are instead of being copied first. The descriptor has to be blocking. Only supported
+ * on POSIX platforms, JSON_ERROR_IO being returned elsewhere.
+ * @param value JSON value to serialize.
+ * @param fd File descriptor to write the JSON output to.
+ * @param options Optional formatting options (NULL for default values).
+ * @return json_error Status code.
+ */
+json_error json_serialize_to_fd(const json_value *value, int fd, const json_format_options *options);
+
 #ifdef __cplusplus
 }
 #endif
@@ -56,6 +56,63 @@ void test_number_creation_and_access()
     json_free(value);
 }
 
+void test_integer_creation_and_access()
+{
+    json_value *value = NULL;
+    json_error error = json_integer_create(INT64_MIN, &value);
+
+    ASSERT_JSON_SUCCESS("Create integer value", error);
+    ASSERT_JSON_TYPE("Integer value has correct type", value, JSON_NUMBER);
+    int64_t integer = 0;
+    error = json_integer_get(value, &integer);
+    ASSERT_JSON_SUCCESS("Get integer value", error);
+    ASSERT("Integer value is correct", integer == INT64_MIN);
+    ASSERT_JSON_GET_NUMBER("Integer value converts to a number", value, -9223372036854775808.0);
+    uint64_t unsigned_integer;
+    error = json_unsigned_get(value, &unsigned_integer);
+    ASSERT_JSON_ERROR("Negative integer is not unsigned", error, JSON_ERROR_OUT_OF_RANGE);
+    json_free(value);
+
+    error = json_unsigned_create(UINT64_MAX, &value);
+    ASSERT_JSON_SUCCESS("Create unsigned value", error);
+    error = json_unsigned_get(value, &unsigned_integer);
+    ASSERT_JSON_SUCCESS("Get unsigned value", error);
+    ASSERT("Unsigned value is correct", unsigned_integer == UINT64_MAX);
+    error = json_integer_get(value, &integer);
+    ASSERT_JSON_ERROR("Unsigned value above INT64_MAX is not an integer", error, JSON_ERROR_OUT_OF_RANGE);
+    json_free(value);
+
+    /* Numbers stored as doubles convert when integral */
+    json_number_create(3.0, &value);
+    error = json_integer_get(value, &integer);
+    ASSERT_JSON_SUCCESS("Get integer from integral number", error);
+    ASSERT_EQUAL_INT("Integral number is correct", 3, integer);
+    json_set_as_number(value, 42.5);
+    error = json_integer_get(value, &integer);
+    ASSERT_JSON_ERROR("Fractional number is not an integer", error, JSON_ERROR_OUT_OF_RANGE);
+    json_set_as_number(value, 1e300);
+    error = json_unsigned_get(value, &unsigned_integer);
+    ASSERT_JSON_ERROR("Huge number is not unsigned", error, JSON_ERROR_OUT_OF_RANGE);
+
+    error = json_set_as_integer(value, -7);
+    ASSERT_JSON_SUCCESS("Change to integer", error);
+    json_integer_get(value, &integer);
+    ASSERT_EQUAL_INT("Changed integer is correct", -7, integer);
+
+    json_value *clone = NULL;
+    error = json_clone(value, &clone);
+    ASSERT_JSON_SUCCESS("Clone integer value", error);
+    json_integer_get(clone, &integer);
+    ASSERT_EQUAL_INT("Cloned integer is correct", -7, integer);
+    json_free(clone);
+    json_free(value);
+
+    json_bool_create(true, &value);
+    error = json_integer_get(value, &integer);
+    ASSERT_JSON_ERROR("Bool value is not an integer", error, JSON_ERROR_WRONG_TYPE);
+    json_free(value);
+}
+
 void test_string_creation_and_access()
 {
     const char *test_str = "Hello, JSON!";
@@ -100,6 +157,65 @@ void test_string_nocopy_creation_and_access()
     json_free(value);
 }
 
+void test_short_and_long_strings()
+{
+    const char *short_str = "fifteen chars!!";
+    const char *long_str = "sixteen chars!!!";
+    json_value *value = NULL, *copy = NULL;
+    const char *str_val;
+
+    json_error error = json_string_create(short_str, &value);
+    ASSERT_JSON_SUCCESS("Create short string value", error);
+    ASSERT_JSON_GET_STRING("Short string value is correct", value, short_str);
+    error = json_set_as_string(value, long_str);
+    ASSERT_JSON_SUCCESS("Change short string to long string", error);
+    ASSERT_JSON_GET_STRING("Long string value is correct", value, long_str);
+    error = json_set_as_string(value, "");
+    ASSERT_JSON_SUCCESS("Change long string to empty string", error);
+    ASSERT_JSON_GET_STRING("Empty string value is correct", value, "");
+
+    /* A value can be set to its own string */
+    json_set_as_string(value, short_str);
+    json_string_get(value, &str_val);
+    error = json_set_as_string(value, str_val);
+    ASSERT_JSON_SUCCESS("Set short string to itself", error);
+    ASSERT_JSON_GET_STRING("Short string set to itself is kept", value, short_str);
+    json_set_as_string(value, long_str);
+    json_string_get(value, &str_val);
+    json_set_as_string(value, str_val);
+    ASSERT_JSON_GET_STRING("Long string set to itself is kept", value, long_str);
+
+    /* Strings carry their length, null characters included */
+    size_t length;
+    error = json_set_as_string_len(value, "a\0b", 3);
+    ASSERT_JSON_SUCCESS("Change to string with a null character", error);
+    json_string_get_len(value, &str_val, &length);
+    ASSERT_EQUAL_INT("Short string length counts null characters", 3, length);
+    json_free(value);
+    error = json_string_create_len("sixteen\0chars!!!", 16, &value);
+    ASSERT_JSON_SUCCESS("Create long string with a null character", error);
+    error = json_clone(value, &copy);
+    ASSERT_JSON_SUCCESS("Clone long string with a null character", error);
+    json_string_get_len(copy, &str_val, &length);
+    ASSERT_EQUAL_INT("Cloned string keeps its length", 16, length);
+    ASSERT("Cloned string keeps its characters", !memcmp(str_val, "sixteen\0chars!!!", 17));
+    json_free(copy);
+    json_set_as_string(value, long_str);
+    json_string_get_len(value, &str_val, &length);
+    ASSERT_EQUAL_INT("Long string length is correct", 16, length);
+    json_set_as_string(value, short_str);
+    json_string_get_len(value, &str_val, &length);
+    ASSERT_EQUAL_INT("Full short string length is correct", 15, length);
+
+    error = json_clone(value, &copy);
+    ASSERT_JSON_SUCCESS("Clone short string value", error);
+    ASSERT_JSON_GET_STRING("Cloned short string is correct", copy, short_str);
+    json_set_as_number(value, 1);
+    ASSERT_JSON_GET_STRING("Cloned short string is independent", copy, short_str);
+    json_free(copy);
+    json_free(value);
+}
+
 void test_change_to_null()
 {
     json_value *value = NULL;
@@ -324,6 +440,48 @@ void test_null_errors_modification()
     free(value);
 }
 
+void test_node_pool()
+{
+    json_value *value, *reused, *array, *item;
+    json_node_pool_set_limit(64 * 1024);
+
+    json_number_create(1, &value);
+    json_free(value);
+    json_error error = json_bool_create(true, &reused);
+    ASSERT_JSON_SUCCESS("Create value from pool", error);
+    ASSERT_EQUAL_PTR("Freed value is reused", value, reused);
+    ASSERT_JSON_GET_BOOL("Reused value is correct", reused, true);
+    json_free(reused);
+
+    // Arrays move between size classes as they grow and shrink
+    json_array_create(&array);
+    for (int i = 0; i < 100; ++i)
+    {
+        json_number_create(i, &item);
+        json_array_append(array, item);
+    }
+    json_array_get(array, 99, &item);
+    ASSERT_JSON_GET_NUMBER("Array grown from pool is correct", item, 99.0);
+    for (int i = 0; i < 95; ++i)
+        json_array_remove(array, 0, NULL);
+    json_array_shrink_to_fit(array);
+    json_array_get(array, 0, &item);
+    ASSERT_JSON_GET_NUMBER("Array shrunk into pool is correct", item, 95.0);
+    json_free(array);
+
+    error = json_parse_string("{\"a\": [1, 2, {\"b\": \"long enough to be allocated\"}]}", &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse with pool", error);
+    json_object_get(value, "a", &array);
+    ASSERT_JSON_ARRAY_LENGTH("Parsed array from pool is correct", array, 3);
+    json_free(value);
+
+    // Setting the limit to 0 frees what the thread kept
+    json_node_pool_set_limit(0);
+    json_null_create(&value);
+    ASSERT_JSON_TYPE("Create value without pool", value, JSON_NULL);
+    json_free(value);
+}
+
 int main()
 {
     BEGIN_TESTS();
@@ -331,8 +489,10 @@ int main()
     test_null_creation_and_access();
     test_bool_creation_and_access();
     test_number_creation_and_access();
+    test_integer_creation_and_access();
     test_string_creation_and_access();
     test_string_nocopy_creation_and_access();
+    test_short_and_long_strings();
     
     test_change_to_null();
     test_change_to_bool();
@@ -344,6 +504,8 @@ int main()
     test_bool_clone();
     test_number_clone();
     test_string_clone();
+
+    test_node_pool();
     
     test_null_errors_creation();
     test_null_errors_access();
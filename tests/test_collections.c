@@ -158,6 +158,42 @@ void test_array_remove()
     json_free(array);
 }
 
+void test_array_reserve_and_shrink()
+{
+    json_value *array, *item;
+    json_array_create(&array);
+
+    json_error error = json_array_reserve(array, 1000);
+    ASSERT_JSON_SUCCESS("Reserve array capacity", error);
+    ASSERT_JSON_ARRAY_LENGTH("Reserving keeps the array empty", array, 0);
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        json_number_create(i, &item);
+        json_array_append(array, item);
+    }
+    json_number_create(-1, &item);
+    json_array_insert(array, 0, item);
+    ASSERT_JSON_ARRAY_LENGTH("Array grows past its reserved capacity", array, 2001);
+
+    for (int i = 0; i < 1500; ++i)
+        json_array_remove(array, 1, NULL);
+    error = json_array_shrink_to_fit(array);
+    ASSERT_JSON_SUCCESS("Shrink array to fit", error);
+    ASSERT_JSON_ARRAY_LENGTH("Shrinking keeps the values", array, 501);
+    json_array_get(array, 500, &item);
+    ASSERT_JSON_GET_NUMBER("Last value is kept after shrinking", item, 1999.0);
+
+    json_number_create(2000, &item);
+    error = json_array_append(array, item);
+    ASSERT_JSON_SUCCESS("Append after shrinking", error);
+    ASSERT_JSON_ARRAY_LENGTH("Array grows after shrinking", array, 502);
+
+    error = json_array_reserve(NULL, 10);
+    ASSERT_JSON_ERROR("Reserve NULL array causes error", error, JSON_ERROR_NULL);
+    json_free(array);
+}
+
 void test_array_errors()
 {
     json_value *array, *item;
@@ -315,6 +351,134 @@ void test_object_clone()
     json_free(clone);
 }
 
+void test_shared_clone()
+{
+    json_format_options format = { .indent_size = 0, .max_depth = 1000 };
+    json_value *base, *first, *second, *third, *list, *item;
+    char *text;
+
+    json_error error = json_parse_string("{\"name\":\"base\",\"list\":[1,2,{\"a\":\"x\"}],\"meta\":{\"v\":1}}", &base, NULL);
+    ASSERT_JSON_SUCCESS("Parse base document", error);
+    json_value *base_list;
+    json_object_get(base, "list", &base_list);
+    error = json_clone(base, &first);
+    ASSERT_JSON_SUCCESS("Clone object", error);
+    json_clone(first, &second);
+    ASSERT_JSON_OBJECT_SIZE("Clone has correct size", first, 3);
+
+    // The source keeps its own values, which can still be modified
+    json_array_get(base_list, 0, &item);
+    error = json_set_as_number(item, -1);
+    ASSERT_JSON_SUCCESS("Value of the source stays writable", error);
+    json_string_create("z", &item);
+    error = json_array_append(base_list, item);
+    ASSERT_JSON_SUCCESS("Array of the source stays writable", error);
+    json_object_get(first, "list", &list);
+    ASSERT_NOT_EQUAL_PTR("Clone doesn't read the values of the source", base_list, list);
+    ASSERT_JSON_ARRAY_LENGTH("Clone doesn't see changes to the source", list, 3);
+
+    // Reading clones reads the shared values, which can't be modified
+    json_value *shared_list;
+    json_object_get(second, "list", &shared_list);
+    ASSERT_EQUAL_PTR("Clones read the same values", list, shared_list);
+    json_array_get(list, 0, &item);
+    ASSERT_JSON_GET_NUMBER("Shared value is correct", item, 1.0);
+    error = json_set_as_number(item, 10);
+    ASSERT_JSON_ERROR("Shared value is read-only", error, JSON_ERROR_READ_ONLY);
+    json_value *string;
+    json_string_create("y", &string);
+    error = json_array_append(list, string);
+    ASSERT_JSON_ERROR("Shared array is read-only", error, JSON_ERROR_READ_ONLY);
+
+    // Modifying a clone copies the containers on the way to the change
+    error = json_object_get_mutable(first, "list", &list);
+    ASSERT_JSON_SUCCESS("Get member of clone to modify it", error);
+    json_object_get(first, "meta", &item);
+    json_object_get(item, "v", &item);
+    json_object_get(second, "meta", &shared_list);
+    json_object_get(shared_list, "v", &shared_list);
+    ASSERT_EQUAL_PTR("Untouched containers stay shared", item, shared_list);
+    json_array_get_mutable(list, 2, &item);
+    error = json_object_set(item, "a", string);
+    ASSERT_JSON_SUCCESS("Set member of clone", error);
+    json_array_get_mutable(list, 0, &item);
+    error = json_set_as_number(item, 10);
+    ASSERT_JSON_SUCCESS("Set value of clone", error);
+    json_object_remove(first, "name", NULL);
+
+    json_serialize_to_string(first, &text, &format);
+    ASSERT_EQUAL_STRING("Modified clone is correct", "{\"list\":[10,2,{\"a\":\"y\"}],\"meta\":{\"v\":1}}", text);
+    free(text);
+    json_serialize_to_string(base, &text, &format);
+    ASSERT_EQUAL_STRING("Source has its own changes only", "{\"name\":\"base\",\"list\":[-1,2,{\"a\":\"x\"},\"z\"],\"meta\":{\"v\":1}}", text);
+    free(text);
+    json_serialize_to_string(second, &text, &format);
+    ASSERT_EQUAL_STRING("Other clone is unchanged", "{\"name\":\"base\",\"list\":[1,2,{\"a\":\"x\"}],\"meta\":{\"v\":1}}", text);
+    free(text);
+
+    // Clones of a modified clone see its changes, and not the later ones
+    json_clone(first, &third);
+    json_object_get_mutable(first, "meta", &item);
+    json_number_create(2, &string);
+    json_object_set(item, "v", string);
+    json_object_get(third, "meta", &item);
+    json_object_get(item, "v", &item);
+    ASSERT_JSON_GET_NUMBER("Clone of a clone keeps its own values", item, 1.0);
+    json_object_get(third, "list", &item);
+    json_array_get(item, 0, &item);
+    ASSERT_JSON_GET_NUMBER("Clone of a clone sees earlier changes", item, 10.0);
+
+    // Values read from a clone are shared too, and outlive it
+    json_free(base);
+    json_object_get(second, "meta", &item);
+    json_clone(item, &base);
+    json_free(second);
+    ASSERT_JSON_OBJECT_SIZE("Clone of a shared value is correct", base, 1);
+    json_object_get_mutable(base, "v", &item);
+    error = json_set_as_number(item, 3);
+    ASSERT_JSON_SUCCESS("Set value of clone of a shared value", error);
+    json_free(base);
+    json_free(first);
+    json_free(third);
+
+    // Lazily parsed containers are parsed in the copy, which doesn't depend on a document
+    const char input[] = "{\"list\":[1,{\"a\":[]}]}";
+    json_document *document;
+    json_document_create(&document);
+    json_parse_options options = { .max_depth = 1000, .lazy = true };
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        options.document = mode ? document : NULL;
+        json_parse_string(input, &base, &options);
+        json_object_get(base, "list", &list);
+        error = json_clone(list, &first);
+        ASSERT_JSON_SUCCESS("Clone parsed array", error);
+        if (!mode)
+            json_free(base);
+        json_array_get_mutable(first, 1, &item);
+        json_object_get_mutable(item, "a", &item);
+        json_null_create(&string);
+        json_array_append(item, string);
+        json_serialize_to_string(first, &text, &format);
+        ASSERT_EQUAL_STRING("Clone of parsed array is correct", "[1,{\"a\":[null]}]", text);
+        free(text);
+        json_free(first);
+    }
+    json_document_free(document);
+
+    // Other values are copied
+    json_number_create(3, &item);
+    error = json_clone(item, &first);
+    ASSERT_JSON_SUCCESS("Clone number", error);
+    ASSERT_JSON_GET_NUMBER("Clone of number is correct", first, 3.0);
+    ASSERT_NOT_EQUAL_PTR("Clone of number is a copy", item, first);
+    json_free(item);
+    json_free(first);
+
+    error = json_clone(NULL, &first);
+    ASSERT_JSON_ERROR("Clone NULL value", error, JSON_ERROR_NULL);
+}
+
 void test_object_remove()
 {
     json_value *first_item, *second_item, *object;
@@ -340,6 +504,121 @@ void test_object_remove()
     json_free(object);
 }
 
+void test_large_object()
+{
+    char key[16];
+    json_value *object, *item, *clone;
+    json_object_create(&object);
+    for (int i = 0; i < 1000; ++i)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        json_number_create(i, &item);
+        json_object_set(object, key, item);
+    }
+    ASSERT_JSON_OBJECT_SIZE("Large object has all members", object, 1000);
+
+    json_number_create(-1, &item);
+    json_object_set(object, "k500", item);
+    ASSERT_JSON_OBJECT_SIZE("Replacing a member keeps the size", object, 1000);
+
+    int found = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        double number;
+        snprintf(key, sizeof(key), "k%d", i);
+        if (json_object_get(object, key, &item) == JSON_SUCCESS && json_number_get(item, &number) == JSON_SUCCESS
+            && number == (i == 500 ? -1 : i))
+            found++;
+    }
+    ASSERT_EQUAL_INT("Large object members are found", 1000, found);
+
+    /* Removing members keeps the order and the lookups of the others */
+    for (int i = 0; i < 1000; i += 2)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        json_object_remove(object, key, NULL);
+    }
+    ASSERT_JSON_OBJECT_SIZE("Half of the members are removed", object, 500);
+    ASSERT_JSON_GET_OBJECT_NOT_FOUND("Removed member is not found", object, "k998");
+
+    found = 0;
+    for (int i = 1; i < 1000; i += 2)
+    {
+        double number;
+        snprintf(key, sizeof(key), "k%d", i);
+        if (json_object_get(object, key, &item) == JSON_SUCCESS && json_number_get(item, &number) == JSON_SUCCESS
+            && number == i)
+            found++;
+    }
+    ASSERT_EQUAL_INT("Remaining members are found after removals", 500, found);
+
+    json_object_remove(object, "k999", NULL);
+    ASSERT_JSON_GET_OBJECT_NOT_FOUND("Removed last member is not found", object, "k999");
+    json_object_get(object, "k997", &item);
+    ASSERT_JSON_GET_NUMBER("Member before last removed one is found", item, 997.0);
+    json_number_create(999, &item);
+    json_object_set(object, "k999", item);
+
+    json_clone(object, &clone);
+    json_free(object);
+    found = 0;
+    for (int i = 1; i < 1000; i += 2)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        if (json_object_get(clone, key, &item) == JSON_SUCCESS)
+            found++;
+    }
+    ASSERT_EQUAL_INT("Remaining members are found in clone", 500, found);
+
+    char *output = NULL;
+    json_format_options format = { .indent_size = 0, .max_depth = 10 };
+    json_serialize_to_string(clone, &output, &format);
+    ASSERT_NOT_NULL("Serialize large object", output);
+    if (output)
+        ASSERT_EQUAL_INT("Members keep their insertion order", 0, strncmp(output, "{\"k1\":1,\"k3\":3,\"k5\":5,", 22));
+    free(output);
+    json_free(clone);
+}
+
+void test_object_reserve_and_shrink()
+{
+    char key[16];
+    json_value *object, *item;
+    json_object_create(&object);
+
+    json_error error = json_object_reserve(object, 100);
+    ASSERT_JSON_SUCCESS("Reserve object capacity", error);
+    ASSERT_JSON_OBJECT_SIZE("Reserving keeps the object empty", object, 0);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        json_number_create(i, &item);
+        json_object_set(object, key, item);
+    }
+    ASSERT_JSON_OBJECT_SIZE("Object grows past its reserved capacity", object, 200);
+
+    for (int i = 0; i < 190; ++i)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        json_object_remove(object, key, NULL);
+    }
+    error = json_object_shrink_to_fit(object);
+    ASSERT_JSON_SUCCESS("Shrink object to fit", error);
+    ASSERT_JSON_OBJECT_SIZE("Shrinking keeps the members", object, 10);
+    json_object_get(object, "k195", &item);
+    ASSERT_JSON_GET_NUMBER("Member is found after shrinking", item, 195.0);
+
+    json_null_create(&item);
+    error = json_object_set(object, "added", item);
+    ASSERT_JSON_SUCCESS("Add member after shrinking", error);
+    ASSERT_JSON_GET_OBJECT("Added member is found", object, "added", item);
+
+    error = json_object_shrink_to_fit(NULL);
+    ASSERT_JSON_ERROR("Shrink NULL object causes error", error, JSON_ERROR_NULL);
+    json_free(object);
+}
+
 void test_object_errors()
 {
     json_value *object, *item;
@@ -387,6 +666,172 @@ void test_object_errors()
     json_free(item);
 }
 
+void test_key_pool()
+{
+    char key[16];
+    json_key_pool *pool;
+    json_value *object, *item;
+    const char *interned, *again, *other;
+
+    json_error error = json_key_pool_create(&pool);
+    ASSERT_JSON_SUCCESS("Create key pool", error);
+
+    error = json_key_intern(pool, "name", &interned);
+    ASSERT_JSON_SUCCESS("Intern key", error);
+    ASSERT_EQUAL_STRING("Interned key keeps its text", "name", interned);
+    json_key_intern(pool, "name", &again);
+    ASSERT_EQUAL_PTR("Interning twice gives the same key", interned, again);
+    json_key_intern(pool, "other", &other);
+    ASSERT_NOT_EQUAL_PTR("Different keys are interned apart", interned, other);
+
+    json_object_create(&object);
+    json_number_create(1, &item);
+    error = json_object_set_interned(object, interned, item);
+    ASSERT_JSON_SUCCESS("Set member by interned key", error);
+    json_number_create(2, &item);
+    json_object_set(object, "copied", item);
+    ASSERT_JSON_OBJECT_SIZE("Interned and copied keys mix", object, 2);
+
+    error = json_object_get_interned(object, interned, &item);
+    ASSERT_JSON_SUCCESS("Get member by interned key", error);
+    ASSERT_JSON_GET_NUMBER("Member found by interned key", item, 1.0);
+    ASSERT_JSON_GET_OBJECT("Interned key is found by text", object, "name", item);
+    error = json_object_get_interned(object, other, &item);
+    ASSERT_JSON_ERROR("Missing interned key is not found", error, JSON_ERROR_KEY_NOT_FOUND);
+
+    json_number_create(3, &item);
+    json_object_set_interned(object, other, item);
+    json_object_get(object, "other", &item);
+    ASSERT_JSON_GET_NUMBER("Interned key is copied into objects owning their keys", item, 3.0);
+    json_free(object);
+
+    // Wide objects are searched through their index.
+    json_object_create(&object);
+    for (int i = 0; i < 100; ++i)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        json_key_intern(pool, key, &interned);
+        json_number_create(i, &item);
+        json_object_set_interned(object, interned, item);
+    }
+    json_object_remove(object, "k10", NULL);
+    json_key_intern(pool, "k42", &interned);
+    error = json_object_get_interned(object, interned, &item);
+    ASSERT_JSON_SUCCESS("Get member of wide object by interned key", error);
+    ASSERT_JSON_GET_NUMBER("Member of wide object found by interned key", item, 42.0);
+    json_number_create(-1, &item);
+    json_object_set(object, "added", item);
+    ASSERT_JSON_OBJECT_SIZE("Wide object takes copied keys after interned ones", object, 100);
+    json_object_get(object, "k99", &item);
+    ASSERT_JSON_GET_NUMBER("Interned members are kept", item, 99.0);
+    json_free(object);
+
+    error = json_key_intern(NULL, "name", &interned);
+    ASSERT_JSON_ERROR("Intern into NULL pool causes error", error, JSON_ERROR_NULL);
+    json_key_pool_free(pool);
+}
+
+void test_object_freeze()
+{
+    char key[16];
+    char *text;
+    json_value *object, *item, *copy;
+
+    json_object_create(&object);
+    for (int i = 99; i >= 0; --i)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        json_number_create(i, &item);
+        json_object_set(object, key, item);
+    }
+    json_error error = json_object_freeze(object);
+    ASSERT_JSON_SUCCESS("Freeze object", error);
+    error = json_object_freeze(object);
+    ASSERT_JSON_SUCCESS("Freeze frozen object", error);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        error = json_object_get(object, key, &item);
+        ASSERT_JSON_SUCCESS("Get member of frozen object", error);
+    }
+    error = json_object_get(object, "k0", &item);
+    ASSERT_JSON_SUCCESS("Frozen object finds first key", error);
+    ASSERT_JSON_GET_NUMBER("Frozen object finds correct value", item, 0.0);
+    error = json_object_get(object, "k100", &item);
+    ASSERT_JSON_ERROR("Missing key in frozen object is not found", error, JSON_ERROR_KEY_NOT_FOUND);
+    error = json_object_get(object, "", &item);
+    ASSERT_JSON_ERROR("Empty key in frozen object is not found", error, JSON_ERROR_KEY_NOT_FOUND);
+
+    // Members keep their order
+    json_serialize_to_string(object, &text, NULL);
+    ASSERT("Frozen object keeps member order", strstr(text, "\"k99\"") < strstr(text, "\"k98\""));
+    free(text);
+
+    // Removing members keeps the object frozen
+    json_object_remove(object, "k50", NULL);
+    json_object_remove(object, "k99", NULL);
+    ASSERT_JSON_OBJECT_SIZE("Members are removed from frozen object", object, 98);
+    error = json_object_get(object, "k50", &item);
+    ASSERT_JSON_ERROR("Removed member is not found", error, JSON_ERROR_KEY_NOT_FOUND);
+    error = json_object_get(object, "k49", &item);
+    ASSERT_JSON_SUCCESS("Member after removed one is found", error);
+    ASSERT_JSON_GET_NUMBER("Member after removed one has correct value", item, 49.0);
+    error = json_object_get(object, "k51", &item);
+    ASSERT_JSON_SUCCESS("Member before removed one is found", error);
+    ASSERT_JSON_GET_NUMBER("Member before removed one has correct value", item, 51.0);
+
+    json_clone(object, &copy);
+    error = json_object_get(copy, "k7", &item);
+    ASSERT_JSON_SUCCESS("Clone of frozen object finds members", error);
+    ASSERT_JSON_GET_NUMBER("Clone of frozen object has correct value", item, 7.0);
+    error = json_object_remove(copy, "k7", NULL);
+    ASSERT_JSON_SUCCESS("Remove member from clone of frozen object", error);
+    int found = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        found += json_object_get(copy, key, &item) == JSON_SUCCESS;
+    }
+    ASSERT_EQUAL_INT("Clone of frozen object finds the remaining members", 97, found);
+    json_null_create(&item);
+    json_object_set(copy, "k7", item);
+    ASSERT_JSON_GET_OBJECT("Member added to clone of frozen object is found", copy, "k7", item);
+    json_free(copy);
+
+    // Adding a member thaws the object
+    json_string_create("new", &item);
+    error = json_object_set(object, "added", item);
+    ASSERT_JSON_SUCCESS("Add member to frozen object", error);
+    json_number_create(-1, &item);
+    json_object_set(object, "k1", item);
+    ASSERT_JSON_OBJECT_SIZE("Thawed object has correct size", object, 99);
+    error = json_object_get(object, "added", &item);
+    ASSERT_JSON_SUCCESS("Thawed object finds added member", error);
+    ASSERT_JSON_GET_STRING("Added member has correct value", item, "new");
+    error = json_object_get(object, "k1", &item);
+    ASSERT_JSON_SUCCESS("Thawed object finds replaced member", error);
+    ASSERT_JSON_GET_NUMBER("Replaced member has correct value", item, -1.0);
+    json_free(object);
+
+    // Small objects stay as they are
+    json_object_create(&object);
+    json_null_create(&item);
+    json_object_set(object, "a", item);
+    error = json_object_freeze(object);
+    ASSERT_JSON_SUCCESS("Freeze small object", error);
+    error = json_object_get(object, "a", &item);
+    ASSERT_JSON_SUCCESS("Small frozen object finds member", error);
+    json_free(object);
+
+    json_array_create(&item);
+    error = json_object_freeze(item);
+    ASSERT_JSON_ERROR("Freeze non-object", error, JSON_ERROR_WRONG_TYPE);
+    json_free(item);
+    error = json_object_freeze(NULL);
+    ASSERT_JSON_ERROR("Freeze NULL object", error, JSON_ERROR_NULL);
+}
+
 int main() {
     BEGIN_TESTS();
 
@@ -397,6 +842,7 @@ int main() {
     test_array_set();
     test_array_clone();
     test_array_remove();
+    test_array_reserve_and_shrink();
     test_array_errors();
 
     test_object_creation();
@@ -404,7 +850,12 @@ int main() {
     test_object_set();
     test_object_has_key();
     test_object_clone();
+    test_shared_clone();
     test_object_remove();
+    test_large_object();
+    test_object_reserve_and_shrink();
+    test_key_pool();
+    test_object_freeze();
     test_object_errors();
 
     FINISH_TESTS();
@@ -3,8 +3,19 @@
  * @brief Tests for the JSON parsing functions.
  */
 
+// mkstemp is POSIX.
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "test_framework.h"
 
+#include <errno.h>
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <unistd.h>
+#endif
+
 static int tests_run = 0;
 static int tests_failed = 0;
 
@@ -49,6 +60,29 @@ void test_parsing() {
     ASSERT_JSON_SUCCESS("Get string from parsed value", error);
     ASSERT_EQUAL_STRING("Parsed string has correct value", "test string", str_val);
     json_free(value);
+
+    /* Long strings are copied in runs between escapes */
+    error = json_parse_string("\"a run of plain characters longer than a vector, \\\"escaped\\\" then"
+        " more plain characters\\\\and a final run after the last backslash escape\"", &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse long string", error);
+    json_string_get(value, &str_val);
+    ASSERT_EQUAL_STRING("Parsed long string has correct value", "a run of plain characters longer than a vector,"
+        " \"escaped\" then more plain characters\\and a final run after the last backslash escape", str_val);
+    json_free(value);
+
+    /* Test strings around the size stored in the value itself */
+    error = json_parse_string("[\"fifteen chars!!\", \"sixteen chars!!!\", \"\", \"a\\u0000b\"]", &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse short and long strings", error);
+    json_value *element;
+    json_array_get(value, 0, &element);
+    ASSERT_JSON_GET_STRING("Parsed short string has correct value", element, "fifteen chars!!");
+    json_array_get(value, 1, &element);
+    ASSERT_JSON_GET_STRING("Parsed long string has correct value", element, "sixteen chars!!!");
+    json_array_get(value, 2, &element);
+    ASSERT_JSON_GET_STRING("Parsed empty string has correct value", element, "");
+    json_array_get(value, 3, &element);
+    ASSERT_JSON_GET_STRING("Parsed short string stops at a null character", element, "a");
+    json_free(value);
     
     /* Test array */
     error = json_parse_string("[1, \"two\", true, null]", &value, NULL);
@@ -89,6 +123,840 @@ void test_parsing() {
     json_free(value);
 }
 
+/* Test number grammar and conversion */
+void test_parse_numbers() {
+    struct {
+        const char *input;
+        double expected;
+    } numbers[] = {
+        { "0", 0.0 },
+        { "-0.0", -0.0 },
+        { "0.1", 0.1 },
+        { "-12.5e-1", -1.25 },
+        { "1E+2", 100.0 },
+        { "1e23", 1e23 },
+        { "9007199254740993", 9007199254740992.0 },
+        { "3.14159265358979323846264338327950288", 3.14159265358979323846 },
+        { "2.2250738585072011e-308", 2.2250738585072011e-308 },
+        { "4.9406564584124654e-324", 4.9406564584124654e-324 },
+        { "1.7976931348623157e308", 1.7976931348623157e308 },
+        { "1e-400", 0.0 }
+    };
+
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(*numbers); ++i)
+    {
+        json_value *value = NULL;
+        json_error error = json_parse_string(numbers[i].input, &value, NULL);
+        ASSERT_JSON_SUCCESS("Parse number", error);
+
+        double number = -1.0;
+        json_number_get(value, &number);
+        ASSERT("Parsed number is correctly rounded", number == numbers[i].expected);
+        json_free(value);
+    }
+
+    /* Numbers without fraction or exponent are kept as exact integers */
+    json_value *integers = NULL;
+    json_error error = json_parse_string("[9007199254740993, -9223372036854775808, 18446744073709551615,"
+        " 18446744073709551616, -0, 10.0]", &integers, NULL);
+    ASSERT_JSON_SUCCESS("Parse integers", error);
+
+    json_value *item;
+    int64_t integer = 0;
+    uint64_t unsigned_integer = 0;
+    json_array_get(integers, 0, &item);
+    json_integer_get(item, &integer);
+    ASSERT("Integer above 2^53 is exact", integer == INT64_C(9007199254740993));
+    json_array_get(integers, 1, &item);
+    json_integer_get(item, &integer);
+    ASSERT("Smallest integer is exact", integer == INT64_MIN);
+    json_array_get(integers, 2, &item);
+    json_unsigned_get(item, &unsigned_integer);
+    ASSERT("Largest unsigned integer is exact", unsigned_integer == UINT64_MAX);
+    json_array_get(integers, 3, &item);
+    ASSERT_JSON_GET_NUMBER("Integer above 64 bits is a double", item, 18446744073709551616.0);
+    ASSERT_JSON_ERROR("Integer above 64 bits has no unsigned value", json_unsigned_get(item, &unsigned_integer), JSON_ERROR_OUT_OF_RANGE);
+    json_array_get(integers, 4, &item);
+    double number = 0.0;
+    json_number_get(item, &number);
+    ASSERT("Negative zero keeps its sign", number == 0.0 && signbit(number));
+    json_free(integers);
+
+    /* A stale errno doesn't fail the parse */
+    json_value *value = NULL;
+    errno = ERANGE;
+    error = json_parse_string("[1.5, 2]", &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse numbers with stale errno", error);
+    json_free(value);
+
+    const char *invalid_numbers[] = {
+        "01", "-", "-a", "1.", "1.e5", "1e", "1e+", "1.5.2", "1e5e5", "--1", "1-", "1e400"
+    };
+    for (size_t i = 0; i < sizeof(invalid_numbers) / sizeof(*invalid_numbers); ++i)
+    {
+        error = json_parse_string(invalid_numbers[i], &value, NULL);
+        ASSERT_JSON_ERROR("Invalid number causes error", error, JSON_ERROR_NUMBER_FORMAT);
+    }
+}
+
+/* Test parsing from a buffer of known length */
+void test_parse_buffer() {
+    json_value *value = NULL;
+    json_value *item;
+    const char *str_val;
+
+    /* Only the first 9 bytes are part of the input */
+    const char buffer[] = "[1, \"ab\"] trailing garbage";
+    json_error error = json_parse_buffer(buffer, 9, &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse buffer prefix", error);
+    ASSERT_JSON_ARRAY_LENGTH("Parsed buffer has correct length", value, 2);
+    json_array_get(value, 1, &item);
+    ASSERT_JSON_GET_STRING("Parsed buffer string is correct", item, "ab");
+    json_free(value);
+
+    error = json_parse_buffer(buffer, 8, &value, NULL);
+    ASSERT_JSON_ERROR("Truncated buffer causes error", error, JSON_ERROR_UNEXPECTED_CHARACTER);
+
+    error = json_parse_buffer("", 0, &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse empty buffer", error);
+    ASSERT_NULL("Empty buffer gives no value", value);
+
+    /* Whitespace inside strings is preserved */
+    error = json_parse_string("\"  a\\n b \"", &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse string with inner blanks", error);
+    error = json_string_get(value, &str_val);
+    ASSERT_EQUAL_STRING("Inner blanks are preserved", "  a\n b ", str_val);
+    json_free(value);
+}
+
+/* Test parsing from a file */
+void test_parse_file() {
+    FILE *file = tmpfile();
+    ASSERT_NOT_NULL("Create temporary file", file);
+    if (!file) return;
+
+    fputs("{\n  \"list\": [1, 2, 3],\n  \"name\": \"file\"\n}\n", file);
+    rewind(file);
+
+    json_value *value = NULL;
+    json_error error = json_parse_file(file, &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse file", error);
+    ASSERT_JSON_OBJECT_SIZE("Parsed file object has correct size", value, 2);
+
+    json_value *name;
+    json_object_get(value, "name", &name);
+    ASSERT_JSON_GET_STRING("Parsed file string is correct", name, "file");
+    json_free(value);
+    fclose(file);
+
+    /* Tokens and escapes straddling read buffer boundaries */
+    json_parse_options options = {
+        .max_depth = 1000,
+        .read_buffer_size = 3
+    };
+    file = tmpfile();
+    ASSERT_NOT_NULL("Create temporary file", file);
+    if (!file) return;
+    fputs("[\"\\u00e9t\\u00e9\", 12345.5, true, \"\\uD83D\\uDE00\"]", file);
+    rewind(file);
+    error = json_parse_file(file, &value, &options);
+    ASSERT_JSON_SUCCESS("Parse file with small read buffer", error);
+    ASSERT_JSON_ARRAY_LENGTH("Parsed array has correct length", value, 4);
+    json_value *item;
+    json_array_get(value, 0, &item);
+    ASSERT_JSON_GET_STRING("Escaped string is correct", item, "\xC3\xA9t\xC3\xA9");
+    json_array_get(value, 1, &item);
+    ASSERT_JSON_GET_NUMBER("Number is correct", item, 12345.5);
+    json_array_get(value, 3, &item);
+    ASSERT_JSON_GET_STRING("Surrogate pair is correct", item, "\xF0\x9F\x98\x80");
+    json_free(value);
+    fclose(file);
+}
+
+// Creates an empty file in the temporary directory and writes its path, or returns false.
+static bool create_temporary_path(char *path, size_t size)
+{
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+    const char *directory = getenv("TMPDIR");
+    if ((size_t)snprintf(path, size, "%s/json_test_XXXXXX", directory && *directory ? directory : "/tmp") >= size)
+        return false;
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return false;
+    close(fd);
+    return true;
+#else
+    char name[L_tmpnam];
+    if (!tmpnam(name) || strlen(name) >= size)
+        return false;
+    strcpy(path, name);
+    return true;
+#endif
+}
+
+/* Test parsing from a file path */
+void test_parse_path() {
+    char path[4096];
+    bool created = create_temporary_path(path, sizeof(path));
+    ASSERT("Create temporary file path", created);
+    if (!created) return;
+    FILE *file = fopen(path, "wb");
+    ASSERT_NOT_NULL("Create test file", file);
+    if (!file) return;
+    fputs("{\"mapped\": [true, \"yes\"]}\n", file);
+    fclose(file);
+
+    json_value *value = NULL;
+    json_error error = json_parse_path(path, &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse file path", error);
+    json_value *array;
+    error = json_object_get(value, "mapped", &array);
+    ASSERT_JSON_SUCCESS("Get array from parsed path", error);
+    ASSERT_JSON_ARRAY_LENGTH("Parsed path array has correct length", array, 2);
+    json_free(value);
+
+    /* Lazy parsing doesn't defer containers of the mapped file */
+    json_parse_options lazy_options = { .max_depth = 1000, .lazy = true };
+    error = json_parse_path(path, &value, &lazy_options);
+    ASSERT_JSON_SUCCESS("Parse file path lazily", error);
+    error = json_object_get(value, "mapped", &array);
+    ASSERT_JSON_SUCCESS("Get nested array from lazily parsed path", error);
+    ASSERT_JSON_ARRAY_LENGTH("Nested array of lazily parsed path has correct length", array, 2);
+    json_value *item;
+    json_array_get(array, 1, &item);
+    ASSERT_JSON_GET_STRING("Nested string of lazily parsed path", item, "yes");
+    json_free(value);
+
+    /* Empty file has no value */
+    file = fopen(path, "wb");
+    ASSERT_NOT_NULL("Truncate test file", file);
+    if (file) fclose(file);
+    error = json_parse_path(path, &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse empty file path", error);
+    ASSERT_NULL("Empty file gives no value", value);
+    remove(path);
+
+    error = json_parse_path(path, &value, NULL);
+    ASSERT_JSON_ERROR("Missing file causes error", error, JSON_ERROR_IO);
+    error = json_parse_path(NULL, &value, NULL);
+    ASSERT_JSON_ERROR("NULL path causes error", error, JSON_ERROR_NULL);
+}
+
+/* Test parsing into a document arena */
+void test_parse_document() {
+    json_document *document;
+    json_error error = json_document_create(&document);
+    ASSERT_JSON_SUCCESS("Create document", error);
+
+    json_parse_options options = {
+        .max_depth = 1000,
+        .document = document
+    };
+
+    json_value *value = NULL;
+    error = json_parse_string("{\"name\": \"doc\", \"list\": [1, 2, {\"a\": null}], \"flag\": false}", &value, &options);
+    ASSERT_JSON_SUCCESS("Parse into document", error);
+    ASSERT_JSON_OBJECT_SIZE("Document object has correct size", value, 3);
+
+    json_value *name, *list, *item;
+    json_object_get(value, "name", &name);
+    ASSERT_JSON_GET_STRING("Document string is correct", name, "doc");
+    json_object_get(value, "list", &list);
+    ASSERT_JSON_ARRAY_LENGTH("Document array has correct length", list, 3);
+    json_array_get(list, 1, &item);
+    ASSERT_JSON_GET_NUMBER("Document number is correct", item, 2.0);
+
+    /* Modifying document values moves what changes to the heap */
+    json_number_create(3, &item);
+    error = json_array_append(list, item);
+    ASSERT_JSON_SUCCESS("Append to document array", error);
+    ASSERT_JSON_ARRAY_LENGTH("Document array grew", list, 4);
+    json_string_create("added", &item);
+    error = json_object_set(value, "added", item);
+    ASSERT_JSON_SUCCESS("Add key to document object", error);
+    ASSERT_JSON_GET_OBJECT("Added key is found", value, "added", item);
+    error = json_object_remove(value, "flag", NULL);
+    ASSERT_JSON_SUCCESS("Remove key from document object", error);
+    json_value *nested;
+    json_array_get(list, 2, &nested);
+    json_object_remove(nested, "a", NULL);
+    json_null_create(&item);
+    error = json_object_set(nested, "b", item);
+    ASSERT_JSON_SUCCESS("Add key to document object after removing one", error);
+    json_object_remove(nested, "b", NULL);
+    error = json_set_as_string(name, "renamed");
+    ASSERT_JSON_SUCCESS("Change document string", error);
+    ASSERT_JSON_GET_STRING("Changed document string is correct", name, "renamed");
+
+    char *output = NULL;
+    json_format_options format = { .indent_size = 0, .max_depth = 1000 };
+    error = json_serialize_to_string(value, &output, &format);
+    ASSERT_JSON_SUCCESS("Serialize document", error);
+    ASSERT_EQUAL_STRING("Serialized document is correct",
+        "{\"name\":\"renamed\",\"list\":[1,2,{},3],\"added\":\"added\"}", output);
+    free(output);
+
+    /* Large input spanning several arena blocks */
+    json_value *large = NULL;
+    size_t count = 5000;
+    char *input = malloc(count * 16 + 3);
+    char *position = input;
+    *position++ = '[';
+    for (size_t i = 0; i < count; ++i)
+        position += sprintf(position, "%s\"item %zu\"", i ? "," : "", i);
+    *position++ = ']';
+    *position = '\0';
+    error = json_parse_string(input, &large, &options);
+    ASSERT_JSON_SUCCESS("Parse large input into document", error);
+    ASSERT_JSON_ARRAY_LENGTH("Large document array has correct length", large, count);
+    json_array_get(large, count - 1, &item);
+    ASSERT_JSON_GET_STRING("Last large document string is correct", item, "item 4999");
+    free(input);
+
+    /* Wide objects are indexed, in the document and once moved to the heap */
+    json_value *wide = NULL;
+    input = malloc(100 * 24 + 3);
+    position = input;
+    *position++ = '{';
+    for (size_t i = 0; i < 100; ++i)
+        position += sprintf(position, "%s\"key %zu\": %zu", i ? "," : "", i, i);
+    *position++ = '}';
+    *position = '\0';
+    error = json_parse_string(input, &wide, &options);
+    ASSERT_JSON_SUCCESS("Parse wide object into document", error);
+    json_object_get(wide, "key 73", &item);
+    ASSERT_JSON_GET_NUMBER("Wide document object member is found", item, 73.0);
+    json_null_create(&item);
+    error = json_object_set(wide, "key 100", item);
+    ASSERT_JSON_SUCCESS("Add key to wide document object", error);
+    ASSERT_JSON_GET_OBJECT("Added wide object key is found", wide, "key 100", item);
+    json_object_get(wide, "key 0", &item);
+    ASSERT_JSON_GET_NUMBER("First wide object member is found", item, 0.0);
+    free(input);
+    json_free(wide);
+
+    json_free(value);
+    json_document_free(document);
+}
+
+/* Test parsing through the structural index */
+void test_structural_index() {
+    json_parse_options options = {
+        .max_depth = 1000,
+        .structural_index = true
+    };
+    json_format_options format = { .indent_size = 0, .max_depth = 1000 };
+
+    /* Escaped quotes and backslash runs spread across 64-byte blocks */
+    const char *input =
+        "{\"log\": [{\"level\": \"info\", \"msg\": \"say \\\"hi\\\" to C:\\\\path\\\\\"},\n"
+        "  {\"level\":\"warn\",\"msg\":\"[not, {structural}: \\\\\\\" here]\",\"code\":-12.5e1},\n"
+        "  true, false, null, 7, \"\\u00e9t\\u00e9\", [], {}]}";
+
+    json_value *indexed = NULL, *streamed = NULL;
+    json_error error = json_parse_string(input, &indexed, &options);
+    ASSERT_JSON_SUCCESS("Parse with structural index", error);
+    error = json_parse_string(input, &streamed, NULL);
+    ASSERT_JSON_SUCCESS("Parse without structural index", error);
+
+    char *indexed_output = NULL, *streamed_output = NULL;
+    json_serialize_to_string(indexed, &indexed_output, &format);
+    json_serialize_to_string(streamed, &streamed_output, &format);
+    ASSERT_NOT_NULL("Serialize indexed value", indexed_output);
+    if (indexed_output && streamed_output)
+        ASSERT_EQUAL_STRING("Indexed value matches streamed value", streamed_output, indexed_output);
+    free(indexed_output);
+    free(streamed_output);
+    json_free(indexed);
+    json_free(streamed);
+
+    json_value *value = NULL;
+    error = json_parse_string("  \n ", &value, &options);
+    ASSERT_JSON_SUCCESS("Parse blank input with structural index", error);
+    ASSERT_NULL("Blank input gives no value", value);
+
+    const char *invalid_inputs[] = {
+        "12a", "[1 2]", "[1,]", "{\"a\" 1}", "{\"a\": 1,}", "[\"open", "true false", "nulls", "[1]]"
+    };
+    for (size_t i = 0; i < sizeof(invalid_inputs) / sizeof(*invalid_inputs); ++i)
+    {
+        error = json_parse_string(invalid_inputs[i], &value, &options);
+        ASSERT_NOT_EQUAL_INT("Invalid input causes error with structural index", JSON_SUCCESS, error);
+    }
+
+    /* Error locations are still reported */
+    json_error_info error_info = {0};
+    options.error_info = &error_info;
+    error = json_parse_string("{\n  \"a\": 1,\n  \"b\": tru\n}", &value, &options);
+    ASSERT_JSON_ERROR("Invalid identifier causes error with structural index", error, JSON_ERROR_UNEXPECTED_IDENTIFIER);
+    ASSERT_EQUAL_INT("Indexed error info has correct line", 3, error_info.line);
+    ASSERT_EQUAL_INT("Indexed error info has correct column", 11, error_info.column);
+}
+
+/* Test parsing in situ, decoding strings inside the mutable input buffer */
+void test_parse_insitu() {
+    json_value *value = NULL;
+    json_value *item;
+    const char *str_val;
+
+    char buffer[] = "{\"k\\u00e9y\": [\"a\\\"b\\\\c\", \"\\ud83d\\ude00!\", 12], \"plain\": \"text\", \"k\\u00e9y\": \"last\"}";
+    json_error error = json_parse_insitu(buffer, strlen(buffer), &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse buffer in situ", error);
+    ASSERT_JSON_OBJECT_SIZE("In-situ object has correct size", value, 2);
+    json_object_get(value, "plain", &item);
+    ASSERT_JSON_GET_STRING("In-situ string is correct", item, "text");
+    ASSERT("In-situ string points into the buffer",
+        json_string_get(item, &str_val) == JSON_SUCCESS && str_val > buffer && str_val < buffer + sizeof(buffer));
+    json_object_get(value, "k\xc3\xa9y", &item);
+    ASSERT_JSON_GET_STRING("Duplicate in-situ key keeps the last value", item, "last");
+
+    /* Parsed objects can still grow, shrink and change */
+    json_value *added;
+    json_string_create("new", &added);
+    error = json_object_set(value, "added", added);
+    ASSERT_JSON_SUCCESS("Add member to in-situ object", error);
+    error = json_object_remove(value, "plain", NULL);
+    ASSERT_JSON_SUCCESS("Remove member from in-situ object", error);
+    json_object_get(value, "added", &item);
+    ASSERT_JSON_GET_STRING("Added member is correct", item, "new");
+    json_free(value);
+
+    char array_buffer[] = "[\"a\\\"b\\\\c\", \"\\ud83d\\ude00!\", {\"x\": \"\\n\"}]";
+    json_parse_options options = { .max_depth = 1000 };
+    for (int indexed = 0; indexed < 2; ++indexed)
+    {
+        char copy[sizeof(array_buffer)];
+        memcpy(copy, array_buffer, sizeof(copy));
+        options.structural_index = indexed;
+        error = json_parse_insitu(copy, strlen(copy), &value, &options);
+        ASSERT_JSON_SUCCESS("Parse array in situ", error);
+        json_array_get(value, 0, &item);
+        ASSERT_JSON_GET_STRING("Escapes are decoded in situ", item, "a\"b\\c");
+        json_array_get(value, 1, &item);
+        ASSERT_JSON_GET_STRING("Surrogate pairs are decoded in situ", item, "\xf0\x9f\x98\x80!");
+        json_array_get(value, 2, &item);
+        json_object_get(item, "x", &item);
+        ASSERT_JSON_GET_STRING("Nested in-situ string is correct", item, "\n");
+        json_free(value);
+    }
+
+    char invalid_buffer[] = "[\"ab\\q\"]";
+    error = json_parse_insitu(invalid_buffer, strlen(invalid_buffer), &value, NULL);
+    ASSERT_JSON_ERROR("Invalid escape causes error in situ", error, JSON_ERROR_ESCAPE_SEQUENCE);
+
+    error = json_parse_insitu(NULL, 0, &value, NULL);
+    ASSERT_JSON_ERROR("NULL in-situ buffer causes error", error, JSON_ERROR_NULL);
+}
+
+void test_lazy_parsing() {
+    json_parse_options options = {
+        .max_depth = 1000,
+        .lazy = true
+    };
+    json_format_options format = { .indent_size = 0, .max_depth = 1000 };
+    json_value *value = NULL;
+    json_value *item;
+    size_t length;
+
+    const char *input =
+        "{\"id\": 7, \"tags\": [\"a]\", \"\\\"[\", {\"deep\": [[1], {\"x\": null}]}],"
+        " \"meta\": {\"name\": \"}{\", \"list\": [true, false]}, \"empty\": []}";
+
+    json_value *lazy = NULL, *eager = NULL;
+    json_error error = json_parse_string(input, &lazy, &options);
+    ASSERT_JSON_SUCCESS("Parse lazily", error);
+    error = json_parse_string(input, &eager, NULL);
+    ASSERT_JSON_SUCCESS("Parse eagerly", error);
+
+    json_object_get(lazy, "id", &item);
+    ASSERT_JSON_GET_NUMBER("Lazy root member is parsed", item, 7.0);
+    json_object_get(lazy, "meta", &item);
+    ASSERT_JSON_OBJECT_SIZE("Deferred object is parsed on access", item, 2);
+    json_object_get(item, "list", &item);
+    ASSERT_JSON_ARRAY_LENGTH("Deferred nested array is parsed on access", item, 2);
+
+    char *lazy_output = NULL, *eager_output = NULL;
+    json_serialize_to_string(lazy, &lazy_output, &format);
+    json_serialize_to_string(eager, &eager_output, &format);
+    ASSERT_NOT_NULL("Serialize lazy value", lazy_output);
+    if (lazy_output && eager_output)
+        ASSERT_EQUAL_STRING("Lazy value matches eager value", eager_output, lazy_output);
+    free(lazy_output);
+    free(eager_output);
+    json_free(eager);
+
+    /* Deferred containers can be modified and cloned */
+    json_value *number, *clone = NULL;
+    json_object_get(lazy, "tags", &item);
+    json_number_create(1, &number);
+    error = json_array_append(item, number);
+    ASSERT_JSON_SUCCESS("Append to deferred array", error);
+    ASSERT_JSON_ARRAY_LENGTH("Deferred array grows", item, 4);
+    json_object_get(lazy, "empty", &item);
+    error = json_clone(item, &clone);
+    ASSERT_JSON_SUCCESS("Clone deferred array", error);
+    ASSERT_JSON_ARRAY_LENGTH("Cloned deferred array is empty", clone, 0);
+    json_free(clone);
+    json_free(lazy);
+
+    /* Errors in nested containers are reported when they are accessed, and located on request */
+    json_error_info error_info = {0};
+    options.error_info = &error_info;
+    error = json_parse_string("{\"a\": [1,\n  2x], \"b\": 3}", &value, &options);
+    ASSERT_JSON_SUCCESS("Invalid nested array is deferred", error);
+    json_object_get(value, "a", &item);
+    error_info.line = 0;
+    error = json_array_length(item, &length);
+    ASSERT_JSON_ERROR("Invalid deferred array causes error on access", error, JSON_ERROR_UNEXPECTED_CHARACTER);
+    ASSERT_EQUAL_INT("Access doesn't use the error info of the parse", 0, error_info.line);
+    error = json_parse_deferred(item, &error_info);
+    ASSERT_JSON_ERROR("Parse invalid deferred array", error, JSON_ERROR_UNEXPECTED_CHARACTER);
+    ASSERT_EQUAL_INT("Deferred error line", 2, error_info.line);
+    ASSERT_EQUAL_INT("Deferred error column", 4, error_info.column);
+    json_object_get(value, "b", &item);
+    ASSERT_JSON_SUCCESS("Parse value that isn't deferred", json_parse_deferred(item, &error_info));
+    ASSERT_JSON_ERROR("Parse deferred NULL value", json_parse_deferred(NULL, NULL), JSON_ERROR_NULL);
+    json_free(value);
+
+    /* Brackets are matched up front */
+    error = json_parse_string("{\"a\": [}]}", &value, &options);
+    ASSERT_JSON_ERROR("Mismatched brackets in nested container cause error", error, JSON_ERROR_UNEXPECTED_CHARACTER);
+    ASSERT_EQUAL_INT("Mismatched bracket column", 8, error_info.column);
+    options.error_info = NULL;
+
+    /* Deferred containers replaced by duplicate keys don't take the input with them */
+    error = json_parse_string("{\"a\": [1], \"a\": 2, \"b\": [3]}", &value, &options);
+    ASSERT_JSON_SUCCESS("Parse lazily with duplicate keys", error);
+    json_object_get(value, "b", &item);
+    ASSERT_JSON_ARRAY_LENGTH("Deferred array after duplicate key is parsed", item, 1);
+    json_free(value);
+
+    error = json_parse_string("{\"a\": [1, \"]\"", &value, &options);
+    ASSERT_JSON_ERROR("Unterminated nested array causes error", error, JSON_ERROR_UNEXPECTED_CHARACTER);
+
+    options.max_depth = 3;
+    error = json_parse_string("[[[[1]]]]", &value, &options);
+    ASSERT_JSON_ERROR("Depth of nested containers is checked up front", error, JSON_ERROR_MAX_DEPTH);
+    error = json_parse_string("[[[1]]]", &value, &options);
+    ASSERT_JSON_SUCCESS("Deep input is deferred", error);
+    json_array_get(value, 0, &item);
+    json_array_get(item, 0, &item);
+    error = json_array_get(item, 0, &item);
+    ASSERT_JSON_ERROR("Maximum depth of values is checked on access", error, JSON_ERROR_MAX_DEPTH);
+    json_free(value);
+}
+
+void test_duplicate_keys() {
+    json_parse_options options = { .max_depth = 1000 };
+    json_value *value = NULL;
+    json_value *item;
+
+    /* Wide objects check duplicates through a hash set */
+    char wide[40 * 12 + 32];
+    char *position = wide;
+    position += sprintf(position, "{");
+    for (int i = 0; i < 40; ++i)
+        position += sprintf(position, "\"k%d\": %d, ", i, i);
+    sprintf(position, "\"k7\": -7}");
+
+    const char *inputs[] = { "{\"a\": 7, \"b\": 2, \"a\": -7}", wide };
+    const char *keys[] = { "a", "k7" };
+    const size_t sizes[] = { 2, 40 };
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        options.structural_index = mode == 1;
+        options.lazy = mode == 2;
+        for (size_t i = 0; i < 2; ++i)
+        {
+            options.duplicate_keys = JSON_DUPLICATE_KEYS_LAST_WINS;
+            json_error error = json_parse_string(inputs[i], &value, &options);
+            ASSERT_JSON_SUCCESS("Parse duplicate keys, last wins", error);
+            ASSERT_JSON_OBJECT_SIZE("Duplicate is dropped when last wins", value, sizes[i]);
+            json_object_get(value, keys[i], &item);
+            ASSERT_JSON_GET_NUMBER("Last value wins", item, -7.0);
+            json_free(value);
+
+            options.duplicate_keys = JSON_DUPLICATE_KEYS_FIRST_WINS;
+            error = json_parse_string(inputs[i], &value, &options);
+            ASSERT_JSON_SUCCESS("Parse duplicate keys, first wins", error);
+            ASSERT_JSON_OBJECT_SIZE("Duplicate is dropped when first wins", value, sizes[i]);
+            json_object_get(value, keys[i], &item);
+            ASSERT_JSON_GET_NUMBER("First value wins", item, 7.0);
+            json_free(value);
+
+            options.duplicate_keys = JSON_DUPLICATE_KEYS_KEEP_ALL;
+            error = json_parse_string(inputs[i], &value, &options);
+            ASSERT_JSON_SUCCESS("Parse duplicate keys, keep all", error);
+            ASSERT_JSON_OBJECT_SIZE("Duplicate is kept", value, sizes[i] + 1);
+            json_object_get(value, keys[i], &item);
+            ASSERT_JSON_GET_NUMBER("Lookup finds the first duplicate", item, 7.0);
+            json_free(value);
+
+            options.duplicate_keys = JSON_DUPLICATE_KEYS_ERROR;
+            error = json_parse_string(inputs[i], &value, &options);
+            ASSERT_JSON_ERROR("Duplicate key causes error", error, JSON_ERROR_DUPLICATE_KEY);
+        }
+    }
+
+    /* Lazily parsed containers report duplicates when accessed */
+    options.structural_index = false;
+    options.lazy = true;
+    json_error error = json_parse_string("{\"outer\": {\"x\": 1, \"x\": 2}}", &value, &options);
+    ASSERT_JSON_SUCCESS("Nested duplicate is deferred", error);
+    json_object_get(value, "outer", &item);
+    error = json_object_get(item, "x", &item);
+    ASSERT_JSON_ERROR("Deferred duplicate key causes error on access", error, JSON_ERROR_DUPLICATE_KEY);
+    json_free(value);
+}
+
+void test_parse_key_pool() {
+    json_parse_options options = { .max_depth = 1000 };
+    json_value *value = NULL;
+    json_value *item;
+    json_key_pool *pool;
+    json_key_pool_create(&pool);
+    options.key_pool = pool;
+
+    const char *id, *name;
+    json_key_intern(pool, "id", &id);
+    json_key_intern(pool, "name", &name);
+
+    const char input[] = "{\"id\": 1, \"tags\": {\"id\": 2, \"name\": \"x\"}, \"id\": 3}";
+    for (int mode = 0; mode < 8; ++mode)
+    {
+        json_document *document = NULL;
+        if (mode & 4)
+            json_document_create(&document);
+        options.document = document;
+        options.structural_index = (mode & 3) == 1;
+        options.lazy = (mode & 3) == 2;
+
+        char buffer[sizeof(input)];
+        memcpy(buffer, input, sizeof(input));
+        json_error error = (mode & 3) == 3
+            ? json_parse_insitu(buffer, strlen(buffer), &value, &options)
+            : json_parse_string(input, &value, &options);
+        ASSERT_JSON_SUCCESS("Parse with key pool", error);
+        ASSERT_JSON_OBJECT_SIZE("Object parsed with key pool has correct size", value, 2);
+        json_object_get_interned(value, id, &item);
+        ASSERT_JSON_GET_NUMBER("Parsed key is found by interned key", item, 3.0);
+        json_object_get(value, "tags", &item);
+        json_object_get_interned(item, name, &item);
+        ASSERT_JSON_GET_STRING("Nested parsed key is found by interned key", item, "x");
+
+        /* Objects parsed with a key pool can still change */
+        json_null_create(&item);
+        error = json_object_set_interned(value, name, item);
+        ASSERT_JSON_SUCCESS("Set interned member of parsed object", error);
+        json_null_create(&item);
+        error = json_object_set(value, "added", item);
+        ASSERT_JSON_SUCCESS("Add member to object parsed with key pool", error);
+        error = json_object_remove(value, "id", NULL);
+        ASSERT_JSON_SUCCESS("Remove member from object parsed with key pool", error);
+        ASSERT_JSON_OBJECT_SIZE("Changed object has correct size", value, 3);
+        json_free(value);
+
+        error = json_parse_string("{\"id\": 1, \"tags\": {\"id\": 2,}}", &value, &options);
+        if (options.lazy)
+        {
+            json_object_get(value, "tags", &item);
+            error = json_object_get(item, "id", &item);
+            json_free(value);
+        }
+        ASSERT_JSON_ERROR("Invalid object parsed with key pool causes error", error, JSON_ERROR_UNEXPECTED_CHARACTER);
+        json_document_free(document);
+    }
+    json_key_pool_free(pool);
+}
+
+void test_parse_freeze_objects() {
+    json_parse_options options = { .max_depth = 1000, .freeze_objects = true };
+    json_value *value = NULL;
+    json_value *item;
+    char input[1024] = "{\"dup\": 1";
+    char key[16];
+
+    for (int i = 0; i < 40; ++i)
+        snprintf(input + strlen(input), sizeof(input) - strlen(input), ", \"k%d\": {\"n\": %d}", i, i);
+    strcat(input, ", \"dup\": 2}");
+
+    for (int mode = 0; mode < 4; ++mode)
+    {
+        json_document *document = NULL;
+        if (mode & 2)
+            json_document_create(&document);
+        options.document = document;
+        options.lazy = mode & 1;
+        options.duplicate_keys = JSON_DUPLICATE_KEYS_KEEP_ALL;
+
+        json_error error = json_parse_string(input, &value, &options);
+        ASSERT_JSON_SUCCESS("Parse frozen objects", error);
+        ASSERT_JSON_OBJECT_SIZE("Frozen object keeps duplicates", value, 42);
+        error = json_object_get(value, "dup", &item);
+        ASSERT_JSON_SUCCESS("Frozen object finds duplicate", error);
+        ASSERT_JSON_GET_NUMBER("Lookup in frozen object finds the first duplicate", item, 1.0);
+        for (int i = 0; i < 40; ++i)
+        {
+            snprintf(key, sizeof(key), "k%d", i);
+            json_object_get(value, key, &item);
+            json_object_get(item, "n", &item);
+            ASSERT_JSON_GET_NUMBER("Parsed frozen object finds member", item, (double)i);
+        }
+
+        json_object_remove(value, "dup", NULL);
+        error = json_object_get(value, "dup", &item);
+        ASSERT_JSON_SUCCESS("Second duplicate is found after removing the first", error);
+        ASSERT_JSON_GET_NUMBER("Second duplicate has correct value", item, 2.0);
+        json_null_create(&item);
+        error = json_object_set(value, "added", item);
+        ASSERT_JSON_SUCCESS("Add member to parsed frozen object", error);
+        error = json_object_get(value, "k39", &item);
+        ASSERT_JSON_SUCCESS("Thawed parsed object finds member", error);
+        json_free(value);
+        json_document_free(document);
+    }
+}
+
+void test_parse_tape() {
+    json_tape *tape = NULL;
+    json_node root, node, item;
+    const char *str_val;
+    size_t size;
+
+    const char input[] = " {\"name\": \"tape\", \"list\": [1, -2, 1.5, 18446744073709551615, true, null, [], {}],"
+        " \"nested\": {\"a\": {\"b\": \"deep\"}}, \"name\": \"duplicate\", \"empty\": \"\"} ";
+    json_error error = json_parse_tape(input, strlen(input), &tape, NULL);
+    ASSERT_JSON_SUCCESS("Parse tape", error);
+    json_tape_root(tape, &root);
+
+    json_type type;
+    json_node_get_type(root, &type);
+    ASSERT_EQUAL_INT("Tape root has correct type", JSON_OBJECT, type);
+    json_node_object_size(root, &size);
+    ASSERT_EQUAL_INT("Tape object keeps every member", 5, size);
+    json_node_object_get(root, "name", &node);
+    json_node_string_get(node, &str_val);
+    ASSERT_EQUAL_STRING("Tape lookup finds the first member", "tape", str_val);
+
+    json_node_object_get(root, "list", &node);
+    json_node_array_length(node, &size);
+    ASSERT_EQUAL_INT("Tape array has correct length", 8, size);
+    int64_t integer;
+    json_node_array_get(node, 1, &item);
+    json_node_integer_get(item, &integer);
+    ASSERT_EQUAL_INT("Tape integer is correct", -2, integer);
+    double number;
+    json_node_array_get(node, 2, &item);
+    json_node_number_get(item, &number);
+    ASSERT_EQUAL_DOUBLE("Tape double is correct", 1.5, number);
+    uint64_t unsigned_integer;
+    json_node_array_get(node, 3, &item);
+    json_node_unsigned_get(item, &unsigned_integer);
+    ASSERT("Tape unsigned integer is correct", unsigned_integer == UINT64_MAX);
+    error = json_node_integer_get(item, &integer);
+    ASSERT_JSON_ERROR("Tape unsigned integer is out of signed range", error, JSON_ERROR_OUT_OF_RANGE);
+    bool boolean;
+    json_node_array_get(node, 4, &item);
+    json_node_bool_get(item, &boolean);
+    ASSERT("Tape boolean is correct", boolean);
+    json_node_array_get(node, 7, &item);
+    json_node_object_size(item, &size);
+    ASSERT_EQUAL_INT("Empty tape object has no members", 0, size);
+    error = json_node_first(item, &item);
+    ASSERT_JSON_ERROR("Empty tape object has no first member", error, JSON_ERROR_INDEX_OUT_OF_BOUNDS);
+    error = json_node_array_get(node, 8, &item);
+    ASSERT_JSON_ERROR("Tape array index out of bounds", error, JSON_ERROR_INDEX_OUT_OF_BOUNDS);
+    error = json_node_string_get(node, &str_val);
+    ASSERT_JSON_ERROR("Tape array is not a string", error, JSON_ERROR_WRONG_TYPE);
+
+    json_node_object_get(root, "nested", &node);
+    json_node_object_get(node, "a", &node);
+    json_node_object_get(node, "b", &node);
+    json_node_string_get(node, &str_val);
+    ASSERT_EQUAL_STRING("Nested tape string is correct", "deep", str_val);
+    json_node_object_get(root, "empty", &node);
+    error = json_node_string_get_len(node, &str_val, &size);
+    ASSERT_JSON_SUCCESS("Get tape string length", error);
+    ASSERT_EQUAL_INT("Empty tape string has no length", 0, size);
+    error = json_node_object_get(root, "missing", &node);
+    ASSERT_JSON_ERROR("Missing tape key is not found", error, JSON_ERROR_KEY_NOT_FOUND);
+
+    /* Members are iterated in a single pass */
+    const char *keys[5];
+    size_t count = 0;
+    for (error = json_node_first(root, &node); !error && count < 5; error = json_node_next(node, &node))
+        json_node_key(node, &keys[count++]);
+    ASSERT_JSON_ERROR("Tape iteration ends after the last member", error, JSON_ERROR_INDEX_OUT_OF_BOUNDS);
+    ASSERT_EQUAL_INT("Tape iteration visits every member", 5, count);
+    ASSERT_EQUAL_STRING("Tape members are iterated in order", "nested", keys[2]);
+    ASSERT_EQUAL_STRING("Last tape member is iterated", "empty", keys[4]);
+    error = json_node_key(root, &str_val);
+    ASSERT_JSON_ERROR("Tape root has no key", error, JSON_ERROR_WRONG_TYPE);
+
+    /* Tape values convert to mutable values */
+    json_value *value;
+    error = json_node_to_value(root, &value);
+    ASSERT_JSON_SUCCESS("Convert tape to value", error);
+    char *output = NULL;
+    json_format_options format = { .indent_size = 0, .max_depth = 1000 };
+    json_serialize_to_string(value, &output, &format);
+    ASSERT_EQUAL_STRING("Converted tape keeps every member",
+        "{\"name\":\"tape\",\"list\":[1,-2,1.5,18446744073709551615,true,null,[],{}],"
+        "\"nested\":{\"a\":{\"b\":\"deep\"}},\"name\":\"duplicate\",\"empty\":\"\"}", output);
+    free(output);
+    json_value *member;
+    json_object_get(value, "name", &member);
+    ASSERT_JSON_GET_STRING("Converted tape lookup finds the first member", member, "tape");
+    json_free(value);
+    json_tape_free(tape);
+
+    /* Wide converted objects are indexed the same way */
+    char wide[40 * 12 + 32];
+    char *position = wide;
+    position += sprintf(position, "{");
+    for (int i = 0; i < 40; ++i)
+        position += sprintf(position, "\"k%d\": %d, ", i, i);
+    sprintf(position, "\"k7\": -7}");
+    json_parse_tape(wide, strlen(wide), &tape, NULL);
+    json_tape_root(tape, &root);
+    json_node_to_value(root, &value);
+    ASSERT_JSON_OBJECT_SIZE("Wide converted tape keeps every member", value, 41);
+    json_object_get(value, "k7", &member);
+    ASSERT_JSON_GET_NUMBER("Wide converted tape lookup finds the first member", member, 7.0);
+    json_free(value);
+    json_tape_free(tape);
+
+    error = json_parse_tape("  ", 2, &tape, NULL);
+    ASSERT_JSON_SUCCESS("Parse empty tape", error);
+    ASSERT_NULL("Empty input gives no tape", tape);
+
+    json_parse_options options = { .max_depth = 2 };
+    const char *invalid[] = { "[1, 2", "{\"a\" 1}", "[1] 2", "[tru]", "[[[1]]]" };
+    const json_error errors[] = { JSON_ERROR_UNEXPECTED_CHARACTER, JSON_ERROR_UNEXPECTED_CHARACTER,
+        JSON_ERROR_UNEXPECTED_CHARACTER, JSON_ERROR_UNEXPECTED_IDENTIFIER, JSON_ERROR_MAX_DEPTH };
+    for (size_t i = 0; i < 5; ++i)
+    {
+        error = json_parse_tape(invalid[i], strlen(invalid[i]), &tape, &options);
+        ASSERT_JSON_ERROR("Invalid tape input causes error", error, errors[i]);
+    }
+}
+
+/* Test error location reporting */
+void test_error_info() {
+    json_error_info error_info = {0};
+    json_parse_options options = {
+        .error_info = &error_info,
+        .max_depth = 1000
+    };
+
+    json_value *value;
+    json_error error = json_parse_string("{\n  \"a\": 1,\n  \"b\": tru\n}", &value, &options);
+    ASSERT_JSON_ERROR("Invalid identifier causes error", error, JSON_ERROR_UNEXPECTED_IDENTIFIER);
+    ASSERT_EQUAL_INT("Error info has error code", JSON_ERROR_UNEXPECTED_IDENTIFIER, error_info.error);
+    ASSERT_EQUAL_INT("Error info has correct line", 3, error_info.line);
+    ASSERT_EQUAL_INT("Error info has correct column", 11, error_info.column);
+}
+
 #define ASSERT_PARSE_ERROR(msg, json_str, error_code) do { \
     json_value *_value; \
     json_error _error = json_parse_string(json_str, &_value, NULL); \
@@ -121,7 +989,20 @@ int main() {
     BEGIN_TESTS();
 
     test_parsing();
+    test_parse_numbers();
+    test_parse_buffer();
+    test_parse_file();
+    test_parse_path();
+    test_parse_document();
+    test_structural_index();
+    test_parse_insitu();
+    test_lazy_parsing();
+    test_duplicate_keys();
+    test_parse_key_pool();
+    test_parse_freeze_objects();
+    test_parse_tape();
     test_errors();
+    test_error_info();
 
     FINISH_TESTS();
 }
\ No newline at end of file
@@ -3,6 +3,11 @@
  * @brief Tests for the JSON serialization functions.
  */
 
+// fileno is POSIX.
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "test_framework.h"
 
 static int tests_run = 0;
@@ -89,10 +94,327 @@ void test_serialization() {
     json_free(parsed);
 }
 
+/* Test integer serialization */
+void test_integer_serialization() {
+    const char *input = "[0,-1,42,9007199254740993,-9223372036854775808,18446744073709551615]";
+    json_value *value = NULL;
+    json_error error = json_parse_string(input, &value, NULL);
+    ASSERT_JSON_SUCCESS("Parse integers", error);
+
+    char *output = NULL;
+    json_format_options options = { .indent_size = 0, .max_depth = 1000 };
+    error = json_serialize_to_string(value, &output, &options);
+    ASSERT_JSON_SUCCESS("Serialize integers", error);
+    ASSERT_NOT_NULL("Integer output is not null", output);
+    if (output)
+        ASSERT_EQUAL_STRING("Integers are serialized exactly", input, output);
+
+    free(output);
+    json_free(value);
+}
+
+/* Test shortest round-trip formatting of doubles */
+void test_double_serialization() {
+    const char *input = "[0.1,1e-07,5e-324,1.7976931348623157e+308,1e+21,123456789.5,0.3,2.2250738585072014e-308,0.0001,1.5e-05,1e+17,-2.5e-10,4503599627370495.5]";
+    json_parse_options parse_options = { .max_depth = 1000 };
+    json_value *value = NULL;
+    json_error error = json_parse_string(input, &value, &parse_options);
+    ASSERT_JSON_SUCCESS("Parse doubles", error);
+
+    char *output = NULL;
+    json_format_options options = { .indent_size = 0, .max_depth = 1000 };
+    error = json_serialize_to_string(value, &output, &options);
+    ASSERT_JSON_SUCCESS("Serialize doubles", error);
+    if (output)
+        ASSERT_EQUAL_STRING("Doubles are serialized with the fewest digits", input, output);
+    free(output);
+    json_free(value);
+
+    json_number_create(-0.0, &value);
+    json_serialize_to_string(value, &output, &options);
+    ASSERT_EQUAL_STRING("Negative zero keeps its sign", "-0", output);
+    free(output);
+    json_free(value);
+
+    json_number_create(HUGE_VAL, &value);
+    json_serialize_to_string(value, &output, &options);
+    ASSERT_EQUAL_STRING("Infinity is serialized as null", "null", output);
+    free(output);
+    json_free(value);
+
+    // Doubles spread over the whole range parse back to the same bits.
+    uint64_t state = 88172645463325252u;
+    int mismatches = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint64_t bits = i % 2 ? state : state & 0x800FFFFFFFFFFFFFu;
+        double number, parsed = 0;
+        memcpy(&number, &bits, sizeof(number));
+        if (!isfinite(number))
+            continue;
+
+        json_number_create(number, &value);
+        json_serialize_to_string(value, &output, &options);
+        json_free(value);
+        value = NULL;
+        if (json_parse_string(output, &value, &parse_options) != JSON_SUCCESS
+            || json_number_get(value, &parsed) != JSON_SUCCESS
+            || memcmp(&parsed, &number, sizeof(number)) != 0)
+            mismatches++;
+        free(output);
+        json_free(value);
+    }
+    ASSERT_EQUAL_INT("Doubles round-trip", 0, mismatches);
+}
+
+/* Test strings holding null characters */
+void test_string_length_serialization() {
+    const char *input = "[\"a\\u0000b\",\"long string with a \\u0000 null character\",\"\\u0000\",\"plain \\\"quoted\\\" \\/ \\u001F\"]";
+    json_parse_options parse_options = { .max_depth = 1000 };
+    json_format_options options = { .indent_size = 0, .max_depth = 1000 };
+    for (int insitu = 0; insitu < 2; ++insitu)
+    {
+        char buffer[128];
+        strcpy(buffer, input);
+        json_value *value = NULL;
+        json_error error = insitu ? json_parse_insitu(buffer, strlen(buffer), &value, &parse_options)
+            : json_parse_string(input, &value, &parse_options);
+        ASSERT_JSON_SUCCESS("Parse strings with null characters", error);
+
+        json_value *item;
+        const char *str_val;
+        size_t length;
+        json_array_get(value, 0, &item);
+        error = json_string_get_len(item, &str_val, &length);
+        ASSERT_JSON_SUCCESS("Get string length", error);
+        ASSERT_EQUAL_INT("Short string keeps its null character", 3, length);
+        ASSERT("Short string characters are kept", !memcmp(str_val, "a\0b", 4));
+        json_array_get(value, 1, &item);
+        json_string_get_len(item, &str_val, &length);
+        ASSERT_EQUAL_INT("Long string keeps its null character", 35, length);
+
+        char *output = NULL;
+        error = json_serialize_to_string(value, &output, &options);
+        ASSERT_JSON_SUCCESS("Serialize strings with null characters", error);
+        if (output)
+            ASSERT_EQUAL_STRING("Null characters round-trip", input, output);
+        free(output);
+        json_free(value);
+    }
+
+    json_value *value = NULL;
+    json_string_create_len("x\0y\0z", 5, &value);
+    char *output = NULL;
+    json_serialize_to_string(value, &output, &options);
+    ASSERT_EQUAL_STRING("Created string with null characters is serialized", "\"x\\u0000y\\u0000z\"", output);
+    free(output);
+    json_free(value);
+}
+
+/* Test escaping of special characters, around and across vector-sized chunks */
+void test_escape_serialization() {
+    json_format_options options = { .indent_size = 0, .max_depth = 1000 };
+    json_value *value = NULL;
+    char *output = NULL;
+    json_string_create("a/b\"c\\d\x01\x7F\b\f\n\r\t\x1F", &value);
+    json_serialize_to_string(value, &output, &options);
+    ASSERT_EQUAL_STRING("Special characters are escaped", "\"a\\/b\\\"c\\\\d\\u0001\\u007F\\b\\f\\n\\r\\t\\u001F\"", output);
+    free(output);
+
+    options.unescaped_slashes = true;
+    json_serialize_to_string(value, &output, &options);
+    ASSERT_EQUAL_STRING("Slashes can be left unescaped", "\"a/b\\\"c\\\\d\\u0001\\u007F\\b\\f\\n\\r\\t\\u001F\"", output);
+    free(output);
+    json_free(value);
+
+    // A single quote at every position of a long string.
+    int mismatches = 0;
+    for (int position = 0; position < 80; ++position)
+    {
+        char text[81], expected[84];
+        memset(text, 'x', 80);
+        text[80] = '\0';
+        text[position] = '"';
+        sprintf(expected, "\"%.*s\\\"%s\"", position, text, text + position + 1);
+
+        json_string_create(text, &value);
+        json_serialize_to_string(value, &output, &options);
+        if (strcmp(output, expected) != 0)
+            mismatches++;
+        free(output);
+        json_free(value);
+    }
+    ASSERT_EQUAL_INT("Quotes are escaped at any position", 0, mismatches);
+}
+
+/* Test output larger than the serializer buffer, and deep indentation */
+void test_file_serialization() {
+    json_value *value = NULL, *item;
+    json_array_create(&value);
+
+    char *long_string = malloc(10001);
+    memset(long_string, 'x', 10000);
+    long_string[10000] = '\0';
+    json_string_create(long_string, &item);
+    json_array_append(value, item);
+
+    json_value *nested = value;
+    for (int depth = 0; depth < 40; ++depth)
+    {
+        json_object_create(&item);
+        json_array_append(nested, item);
+        json_array_create(&nested);
+        json_object_set(item, "nested", nested);
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+        json_number_create(i, &item);
+        json_array_append(value, item);
+    }
+
+    json_format_options options = { .indent_size = 3, .max_depth = 1000 };
+    char *expected = NULL;
+    json_error error = json_serialize_to_string(value, &expected, &options);
+    ASSERT_JSON_SUCCESS("Serialize large value to string", error);
+    char deepest[256] = "\n";
+    memset(deepest + 1, ' ', 240);
+    strcpy(deepest + 241, "\"nested\": [");
+    ASSERT("Deep indentation is serialized", expected && strstr(expected, deepest) != NULL);
+
+    FILE *file = tmpfile();
+    error = json_serialize_to_file(value, file, &options);
+    ASSERT_JSON_SUCCESS("Serialize large value to file", error);
+    long size = ftell(file);
+    ASSERT_EQUAL_INT("File output has the size of string output", (long)strlen(expected), size);
+
+    char *output = malloc(size + 1);
+    rewind(file);
+    output[fread(output, 1, size, file)] = '\0';
+    ASSERT_EQUAL_STRING("File output matches string output", expected, output);
+
+    fclose(file);
+    free(output);
+    free(expected);
+    free(long_string);
+    json_free(value);
+}
+
+/* Test measuring the output and serializing into caller buffers */
+void test_buffer_serialization() {
+    json_value *value = NULL, *item;
+    json_array_create(&value);
+    for (int i = 0; i < 2000; ++i)
+    {
+        json_string_create("some text with a / slash", &item);
+        json_array_append(value, item);
+    }
+
+    char *expected = NULL;
+    json_serialize_to_string(value, &expected, NULL);
+    size_t size = 0;
+    json_error error = json_serialized_size(value, NULL, &size);
+    ASSERT_JSON_SUCCESS("Measure serialized size", error);
+    ASSERT_EQUAL_INT("Size matches the string output", strlen(expected), size);
+
+    char *buffer = malloc(size + 1);
+    size_t length = 0;
+    error = json_serialize_to_buffer(value, buffer, size + 1, &length, NULL);
+    ASSERT_JSON_SUCCESS("Serialize into buffer of the measured size", error);
+    ASSERT_EQUAL_INT("Length of the buffer output", size, length);
+    ASSERT_EQUAL_STRING("Buffer output matches the string output", expected, buffer);
+
+    length = 0;
+    error = json_serialize_to_buffer(value, buffer, size, &length, NULL);
+    ASSERT_JSON_ERROR("Buffer without room for the null character", error, JSON_ERROR_BUFFER_TOO_SMALL);
+    ASSERT_EQUAL_INT("Needed length is reported", size, length);
+    error = json_serialize_to_buffer(value, buffer, 100, &length, NULL);
+    ASSERT_JSON_ERROR("Small buffer", error, JSON_ERROR_BUFFER_TOO_SMALL);
+    ASSERT_EQUAL_INT("Needed length is reported for a small buffer", size, length);
+    ASSERT("Output fitting in a small buffer is written", !memcmp(buffer, expected, 90));
+
+    json_format_options options = { .indent_size = 0, .max_depth = 1000, .unescaped_slashes = true };
+    json_free(value);
+    json_number_create(0.5, &value);
+    error = json_serialize_to_buffer(value, buffer, 4, &length, &options);
+    ASSERT_JSON_SUCCESS("Serialize number into exact buffer", error);
+    ASSERT_EQUAL_STRING("Number in buffer", "0.5", buffer);
+    error = json_serialize_to_buffer(value, buffer, 0, &length, &options);
+    ASSERT_JSON_ERROR("Empty buffer", error, JSON_ERROR_BUFFER_TOO_SMALL);
+    ASSERT_EQUAL_INT("Needed length is reported for an empty buffer", 3, length);
+    buffer[0] = '#';
+    error = json_serialize_to_buffer(NULL, buffer, 0, &length, &options);
+    ASSERT_JSON_ERROR("Empty output in empty buffer", error, JSON_ERROR_BUFFER_TOO_SMALL);
+    ASSERT_EQUAL_INT("Needed length of empty output", 0, length);
+    ASSERT("Empty buffer is not written", buffer[0] == '#');
+
+    free(buffer);
+    free(expected);
+    json_free(value);
+}
+
+/* Test writing to file descriptors, long strings being referenced rather than copied */
+void test_fd_serialization() {
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+    json_value *value = NULL, *item;
+    json_object_create(&value);
+
+    // More long strings than gathered pieces, with escapes splitting some of them.
+    char *long_string = malloc(3001);
+    memset(long_string, 'y', 3000);
+    long_string[3000] = '\0';
+    for (int i = 0; i < 100; ++i)
+    {
+        char key[32];
+        sprintf(key, "key %d", i);
+        if (i % 3 == 0)
+            long_string[i * 20] = '"';
+        json_string_create(long_string, &item);
+        json_object_set(value, key, item);
+        json_number_create(i, &item);
+        json_object_set(value, key + 1, item);
+    }
+
+    char *expected = NULL;
+    json_serialize_to_string(value, &expected, NULL);
+    FILE *file = tmpfile();
+    ASSERT_NOT_NULL("Temporary file is created", file);
+    if (file && expected)
+    {
+        json_error error = json_serialize_to_fd(value, fileno(file), NULL);
+        ASSERT_JSON_SUCCESS("Serialize to file descriptor", error);
+
+        size_t length = strlen(expected);
+        char *output = malloc(length + 2);
+        fseek(file, 0, SEEK_SET);
+        size_t read = fread(output, 1, length + 1, file);
+        ASSERT_EQUAL_INT("File descriptor output has the length of the string output", length, read);
+        ASSERT("File descriptor output matches the string output", read == length && !memcmp(output, expected, length));
+        free(output);
+        fclose(file);
+    }
+
+    ASSERT_JSON_ERROR("Invalid file descriptor", json_serialize_to_fd(value, -1, NULL), JSON_ERROR_IO);
+
+    free(expected);
+    free(long_string);
+    json_free(value);
+#endif
+}
+
 int main() {
     BEGIN_TESTS();
 
     test_serialization();
+    test_integer_serialization();
+    test_double_serialization();
+    test_string_length_serialization();
+    test_escape_serialization();
+    test_file_serialization();
+    test_buffer_serialization();
+    test_fd_serialization();
 
     FINISH_TESTS();
 }
\ No newline at end of file